@@ -0,0 +1,1005 @@
+// Microbenchmarks for the earthquake epicenter locator (Google Benchmark)
+//
+// Build:
+//   g++ -std=c++17 -O3 -pthread earthquake_benchmark.cpp -lbenchmark -o earthquake_benchmark
+// (-std=c++20 adds the coroutine benchmarks)
+// Run with machine-readable output:
+//   ./earthquake_benchmark --benchmark_out=bench.json --benchmark_out_format=json
+//
+// Pass -DEARTHQUAKE_GIT_COMMIT=\"$(git rev-parse --short HEAD)\" to stamp the
+// commit into the JSON context, which plot_results.py uses to label builds.
+//
+// Every benchmark times each call (or each batch of calls, for operations
+// too short for the clock) and reports p50/p99/max per call in microseconds
+// as counters alongside Google Benchmark's own mean. Locate benchmarks add
+// events_per_s and label each run with its configuration, and the JSON
+// output carries allocations per iteration from one extra counted run.
+
+#define EARTHQUAKE_LOCATOR_NO_MAIN
+#include "earthquake_locator.cpp"
+
+#include <benchmark/benchmark.h>
+#include <malloc.h>
+
+#ifndef EARTHQUAKE_GIT_COMMIT
+#define EARTHQUAKE_GIT_COMMIT "unknown"
+#endif
+
+static const GeoBounds CALIFORNIA(32.0, 42.0, -125.0, -114.0);
+static const Point TRUE_EPICENTER(35.0, -120.0);
+
+// Per-call latency samples, reported as percentile counters
+class LatencyRecorder {
+private:
+    vector<double> samples_us;
+    double total_us = 0;
+    size_t calls = 0;
+
+public:
+    // Records one timed region covering calls_per_sample calls
+    void add(steady_clock::time_point start, steady_clock::time_point end,
+             size_t calls_per_sample = 1) {
+        double region_us = duration<double, micro>(end - start).count();
+        samples_us.push_back(region_us / calls_per_sample);
+        total_us += region_us;
+        calls += calls_per_sample;
+    }
+
+    void report(benchmark::State& state) {
+        if (samples_us.empty()) {
+            return;
+        }
+        sort(samples_us.begin(), samples_us.end());
+        auto percentile = [this](double p) {
+            size_t rank = static_cast<size_t>(p * (samples_us.size() - 1) + 0.5);
+            return samples_us[rank];
+        };
+        state.counters["p50_us"] = percentile(0.50);
+        state.counters["p99_us"] = percentile(0.99);
+        state.counters["max_us"] = samples_us.back();
+    }
+    
+    // report plus events_per_s, for benchmarks whose calls each locate one event
+    void reportEvents(benchmark::State& state) {
+        report(state);
+        if (total_us > 0) {
+            state.counters["events_per_s"] = calls / (total_us * 1e-6);
+        }
+    }
+};
+
+// Heap allocations of the whole process, counted while an AllocationCounter
+// run is active. Google Benchmark repeats each benchmark for a few
+// iterations with the counter started and reports allocs_per_iter and
+// max_bytes_used (peak growth of live heap bytes) in its JSON output.
+static atomic<bool> counting_allocations(false);
+static atomic<int64_t> allocation_count(0);
+static atomic<int64_t> allocated_bytes(0);
+static atomic<int64_t> live_bytes(0);
+static atomic<int64_t> peak_live_bytes(0);
+
+static void* countedAllocate(size_t size, size_t alignment) {
+    void* p;
+    if (alignment <= alignof(max_align_t)) {
+        p = malloc(size ? size : 1);
+    } else {
+        p = aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+    if (!p) {
+        throw bad_alloc();
+    }
+    if (counting_allocations.load(memory_order_relaxed)) {
+        int64_t usable = static_cast<int64_t>(malloc_usable_size(p));
+        allocation_count.fetch_add(1, memory_order_relaxed);
+        allocated_bytes.fetch_add(usable, memory_order_relaxed);
+        int64_t live = live_bytes.fetch_add(usable, memory_order_relaxed) + usable;
+        int64_t peak = peak_live_bytes.load(memory_order_relaxed);
+        while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {
+        }
+    }
+    return p;
+}
+
+static void countedFree(void* p) {
+    if (p && counting_allocations.load(memory_order_relaxed)) {
+        live_bytes.fetch_sub(static_cast<int64_t>(malloc_usable_size(p)), memory_order_relaxed);
+    }
+    free(p);
+}
+
+void* operator new(size_t size) { return countedAllocate(size, 0); }
+void* operator new[](size_t size) { return countedAllocate(size, 0); }
+void* operator new(size_t size, align_val_t alignment) { return countedAllocate(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, align_val_t alignment) { return countedAllocate(size, static_cast<size_t>(alignment)); }
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t) noexcept { countedFree(p); }
+void operator delete(void* p, align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { countedFree(p); }
+
+class AllocationCounter : public benchmark::MemoryManager {
+public:
+    void Start() override {
+        allocation_count = 0;
+        allocated_bytes = 0;
+        live_bytes = 0;
+        peak_live_bytes = 0;
+        counting_allocations = true;
+    }
+    
+    void Stop(Result* result) override {
+        counting_allocations = false;
+        result->num_allocs = allocation_count;
+        result->max_bytes_used = peak_live_bytes;
+        result->total_allocated_bytes = allocated_bytes;
+        result->net_heap_growth = live_bytes;
+    }
+};
+
+// Labels a locate run with its configuration as key=value pairs, which
+// plot_results.py splits into columns, and reports its thread count
+static void labelRun(benchmark::State& state, const LocatorConfig& config, ExecPolicy policy,
+                     const string& extra = "") {
+    const char* partition_names[] = {"copy", "in_place", "morton"};
+    size_t threads = 1;
+    if (policy == ExecPolicy::parallel) {
+        threads = config.num_threads ? config.num_threads : max(1u, thread::hardware_concurrency());
+    }
+    string label = string("partition=") + partition_names[static_cast<int>(config.partition_mode)] +
+                   ",precision=" + (config.precision == Precision::float32 ? "float32" : "float64") +
+                   ",policy=" + (policy == ExecPolicy::parallel ? "parallel" : "serial") +
+                   ",threads=" + to_string(threads);
+    if (!extra.empty()) {
+        label += "," + extra;
+    }
+    state.SetLabel(label);
+    state.counters["locate_threads"] = static_cast<double>(threads);
+}
+
+// Build and machine details for the JSON context, next to the host, CPU
+// count and caches that Google Benchmark records itself
+static void addBuildContext() {
+    benchmark::AddCustomContext("git_commit", EARTHQUAKE_GIT_COMMIT);
+    benchmark::AddCustomContext("compiler", __VERSION__);
+    benchmark::AddCustomContext("cplusplus", to_string(__cplusplus));
+#ifdef EARTHQUAKE_INSTRUMENTATION
+    benchmark::AddCustomContext("instrumentation", "on");
+#else
+    benchmark::AddCustomContext("instrumentation", "off");
+#endif
+#ifdef EARTHQUAKE_COROUTINES
+    benchmark::AddCustomContext("coroutines", "on");
+#else
+    benchmark::AddCustomContext("coroutines", "off");
+#endif
+    benchmark::AddCustomContext("kernels", TriangulationKernels::best().name);
+    benchmark::AddCustomContext("hardware_threads", to_string(thread::hardware_concurrency()));
+    
+    string cpu_model = "unknown";
+    ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+    while (getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t colon = line.find(':');
+            if (colon != string::npos && colon + 2 <= line.size()) {
+                cpu_model = line.substr(colon + 2);
+            }
+            break;
+        }
+    }
+    benchmark::AddCustomContext("cpu_model", cpu_model);
+}
+
+static vector<SeismicStation> makeStations(size_t n) {
+    return EarthquakeEpicenterLocator::generateEarthquakeData(static_cast<int>(n), TRUE_EPICENTER, CALIFORNIA);
+}
+
+// One level of the in-place partition over n stations; the set is restored
+// to its original order outside the timed region
+static void BM_Partition(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    vector<SeismicStation> generated = makeStations(n);
+    StationSet original(generated);
+    StationSet stations = original;
+    EarthquakeEpicenterLocator locator;
+    size_t counts[5], offsets[5];
+    double child_min[5];
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        stations = original;
+        auto start = steady_clock::now();
+        locator.partitionRoot(stations, CALIFORNIA, counts, offsets, child_min);
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(counts);
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.report(state);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Leaf solves per kernel set: range(0) = index into available(), range(1) =
+// stations per leaf, range(2) = 0 for the set's generic loops, 1 for
+// fixed_size_leaves (the set's fixed_leaf_limit decides), 2 for the fixed
+// solvers on every leaf. Each sample covers LEAVES different leaves.
+static void BM_LeafTriangulation(benchmark::State& state) {
+    const size_t LEAVES = 1024;
+    const auto& available = TriangulationKernels::available();
+    size_t kernel_index = static_cast<size_t>(state.range(0));
+    if (kernel_index >= available.size()) {
+        state.SkipWithError("kernel set not supported on this CPU");
+        return;
+    }
+    size_t leaf_size = static_cast<size_t>(state.range(1));
+    int64_t mode = state.range(2);
+    const char* mode_names[] = {"/generic", "/auto", "/fixed"};
+    state.SetLabel(string(available[kernel_index]->name) + mode_names[mode]);
+
+    LocatorConfig config;
+    config.kernels = available[kernel_index];
+    config.fixed_size_leaves = mode == 1;
+    EarthquakeEpicenterLocator locator(config);
+    vector<SeismicStation> generated = makeStations(LEAVES * leaf_size);
+    StationSet stations(generated);
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        for (size_t leaf = 0; leaf < LEAVES; leaf++) {
+            StationSetView view = stations.view(leaf * leaf_size, leaf_size);
+            EpicenterResult result = mode == 2
+                ? FIXED_LEAF_SOLVERS[leaf_size](view.latitude, view.longitude, view.detection_time,
+                                                config.kernels->minTime(view.detection_time, leaf_size),
+                                                EarthquakeEpicenterLocator::WAVE_VELOCITY)
+                : locator.simpleTriangulation(view);
+            benchmark::DoNotOptimize(result);
+        }
+        auto end = steady_clock::now();
+        latency.add(start, end, LEAVES);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.report(state);
+    state.SetItemsProcessed(state.iterations() * LEAVES);
+}
+
+// Residual pass over range(1) stations with kernel set range(0): range(2) = 0
+// computes straight-ray times, 1 interpolates them from a 512 x 512 grid
+static void BM_Residuals(benchmark::State& state) {
+    const auto& available = TriangulationKernels::available();
+    size_t kernel_index = static_cast<size_t>(state.range(0));
+    if (kernel_index >= available.size()) {
+        state.SkipWithError("kernel set not supported on this CPU");
+        return;
+    }
+    const TriangulationKernels& kernels = *available[kernel_index];
+    size_t n = static_cast<size_t>(state.range(1));
+    bool use_table = state.range(2) != 0;
+    state.SetLabel(string(kernels.name) + (use_table ? "/table" : "/straight_ray"));
+
+    TravelTimeGrid grid;
+    grid.buildStraightRay(CALIFORNIA, 512, 512, EarthquakeEpicenterLocator::WAVE_VELOCITY);
+    vector<SeismicStation> generated = makeStations(n);
+    StationSet stations(generated);
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        double error = use_table
+            ? kernels.residualErrorTable(stations.latitude.data(), stations.longitude.data(),
+                                         stations.detection_time.data(), n, TRUE_EPICENTER.x,
+                                         TRUE_EPICENTER.y, 0.0, grid.table())
+            : kernels.residualError(stations.latitude.data(), stations.longitude.data(),
+                                    stations.detection_time.data(), n, TRUE_EPICENTER.x,
+                                    TRUE_EPICENTER.y, 0.0, EarthquakeEpicenterLocator::WAVE_VELOCITY);
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(error);
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.report(state);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Combine of four child results; each sample covers CALLS combines
+static void BM_Combine(benchmark::State& state) {
+    const size_t CALLS = 4096;
+    EarthquakeEpicenterLocator locator;
+    mt19937 gen(42);
+    uniform_real_distribution<> unit(0.0, 1.0);
+    vector<EpicenterResult> children;
+    for (size_t i = 0; i < CALLS * 4; i++) {
+        children.push_back(EpicenterResult(Point(32 + 10 * unit(gen), -125 + 11 * unit(gen)),
+                                           unit(gen), unit(gen)));
+    }
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        for (size_t i = 0; i < CALLS; i++) {
+            EpicenterResult result = locator.weightedCombination(
+                Span<const EpicenterResult>(children.data() + 4 * i, 4));
+            benchmark::DoNotOptimize(result);
+        }
+        auto end = steady_clock::now();
+        latency.add(start, end, CALLS);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.report(state);
+    state.SetItemsProcessed(state.iterations() * CALLS);
+}
+
+// BM_Combine's workload with CombineMode::summary statistics
+static void BM_MergeSummaries(benchmark::State& state) {
+    const size_t CALLS = 4096;
+    mt19937 gen(42);
+    uniform_real_distribution<> unit(0.0, 1.0);
+    vector<EpicenterSummary> children(CALLS * 4);
+    for (auto& child : children) {
+        child.count = 8;
+        child.leaves = 1;
+        child.min_arrival = unit(gen);
+        for (int i = 0; i < 8; i++) {
+            double lat = 32 + 10 * unit(gen), lon = -125 + 11 * unit(gen), time = unit(gen);
+            double weight = 1.0 / (1.0 + time * time);
+            child.weight += weight;
+            child.weighted_lat += weight * lat;
+            child.weighted_lon += weight * lon;
+            child.addMoments(lat, lon, time, weight);
+        }
+    }
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        for (size_t i = 0; i < CALLS; i++) {
+            EpicenterSummary summary;
+            for (size_t q = 0; q < 4; q++) {
+                summary.merge(children[4 * i + q]);
+            }
+            benchmark::DoNotOptimize(summary);
+        }
+        auto end = steady_clock::now();
+        latency.add(start, end, CALLS);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.report(state);
+    state.SetItemsProcessed(state.iterations() * CALLS);
+}
+
+// Full locate: range(0) = stations, range(1) = PartitionMode, range(2) = ExecPolicy
+static void BM_Locate(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    LocatorConfig config;
+    const PartitionMode modes[] = {PartitionMode::copy, PartitionMode::in_place, PartitionMode::morton};
+    config.partition_mode = modes[state.range(1)];
+    ExecPolicy policy = state.range(2) ? ExecPolicy::parallel : ExecPolicy::serial;
+    labelRun(state, config, policy);
+
+    EarthquakeEpicenterLocator locator(config);
+    vector<SeismicStation> stations = makeStations(n);
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        EpicenterResult result = locator.locateEpicenter(stations, CALIFORNIA, policy);
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(result);
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.reportEvents(state);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Parallel in-place locate on an owned pool of range(1) threads for the
+// scaling curves: range(2) = 0 strong scaling over range(0) stations in
+// total, 1 weak scaling over range(0) stations per thread
+static void BM_LocateScaling(benchmark::State& state) {
+    bool weak = state.range(2) != 0;
+    size_t threads = static_cast<size_t>(state.range(1));
+    size_t n = static_cast<size_t>(state.range(0)) * (weak ? threads : 1);
+    LocatorConfig config;
+    config.partition_mode = PartitionMode::in_place;
+    config.num_threads = threads;
+    labelRun(state, config, ExecPolicy::parallel, weak ? "scaling=weak" : "scaling=strong");
+
+    EarthquakeEpicenterLocator locator(config);
+    vector<SeismicStation> stations = makeStations(n);
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        EpicenterResult result = locator.locateEpicenter(stations, CALIFORNIA, ExecPolicy::parallel);
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(result);
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.reportEvents(state);
+    state.counters["stations"] = static_cast<double>(n);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+#ifdef EARTHQUAKE_COROUTINES
+// locateAsync of range(0) stations on a pool executor, completing on a
+// LoopExecutor that this thread runs. "loop_gap_max_us" is the longest
+// stretch the loop went without getting control back (C++20 builds only).
+static void BM_LocateAsync(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    LocatorConfig config;
+    config.partition_mode = PartitionMode::in_place;
+    labelRun(state, config, ExecPolicy::parallel, "async=on");
+    EarthquakeEpicenterLocator locator(config);
+    vector<SeismicStation> stations = makeStations(n);
+    WorkStealingPool pool(0);
+    PoolExecutor compute(pool);
+    LoopExecutor loop;
+    LatencyRecorder latency;
+    double max_gap_us = 0;
+
+    for (auto _ : state) {
+        bool done = false;
+        auto start = steady_clock::now();
+        auto last = start;
+        startTask(locator.locateAsync(stations, CALIFORNIA, compute, loop),
+                  [&done](optional<EpicenterResult> result) {
+                      benchmark::DoNotOptimize(result);
+                      done = true;
+                  });
+        loop.runUntil([&] {
+            auto now = steady_clock::now();
+            max_gap_us = max(max_gap_us, duration<double, micro>(now - last).count());
+            last = now;
+            return done;
+        });
+        auto end = steady_clock::now();
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.reportEvents(state);
+    state.counters["loop_gap_max_us"] = max_gap_us;
+    state.SetItemsProcessed(state.iterations() * n);
+}
+#endif
+
+// In-place locate of range(0) stations in Precision range(1) (0 = float64,
+// 1 = float32); location_delta is the distance in degrees from the float64
+// result for the same stations
+static void BM_LocatePrecision(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    bool use_float = state.range(1) != 0;
+    LocatorConfig config;
+    config.partition_mode = PartitionMode::in_place;
+    vector<SeismicStation> stations = makeStations(n);
+    EarthquakeEpicenterLocator reference(config);
+    EpicenterResult expected = reference.locateEpicenter(stations, CALIFORNIA, ExecPolicy::serial);
+    
+    config.precision = use_float ? Precision::float32 : Precision::float64;
+    labelRun(state, config, ExecPolicy::serial);
+    EarthquakeEpicenterLocator locator(config);
+    LatencyRecorder latency;
+    EpicenterResult result;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        result = locator.locateEpicenter(stations, CALIFORNIA, ExecPolicy::serial);
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(result);
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.reportEvents(state);
+    state.counters["location_delta"] = expected.location.distance(result.location);
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetBytesProcessed(state.iterations() * n * (use_float ? 3 * sizeof(float) : 3 * sizeof(double)));
+}
+
+// In-place locate of range(0) stations with LocateEngine range(1) (0 =
+// triangulation, 1 = grid_search); location_error is the distance in
+// degrees from TRUE_EPICENTER
+static void BM_LocateEngine(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    bool grid = state.range(1) != 0;
+    LocatorConfig config;
+    config.partition_mode = PartitionMode::in_place;
+    config.engine = grid ? LocateEngine::grid_search : LocateEngine::triangulation;
+    labelRun(state, config, ExecPolicy::serial, grid ? "engine=grid_search" : "engine=triangulation");
+    EarthquakeEpicenterLocator locator(config);
+    vector<SeismicStation> stations = makeStations(n);
+    LatencyRecorder latency;
+    EpicenterResult result;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        result = locator.locateEpicenter(stations, CALIFORNIA);
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(result);
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.reportEvents(state);
+    state.counters["location_error"] = TRUE_EPICENTER.distance(result.location);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// In-place locate of range(0) stations with branch and bound: range(1) =
+// PruneMode, range(2) = prune_tolerance in tenths of a second
+static void BM_LocatePruned(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    LocatorConfig config;
+    config.partition_mode = PartitionMode::in_place;
+    const PruneMode modes[] = {PruneMode::off, PruneMode::skip, PruneMode::coarse};
+    const char* mode_names[] = {"off", "skip", "coarse"};
+    config.prune_mode = modes[state.range(1)];
+    config.prune_tolerance = state.range(2) / 10.0;
+    labelRun(state, config, ExecPolicy::serial, string("prune=") + mode_names[state.range(1)]);
+
+    EarthquakeEpicenterLocator locator(config);
+    vector<SeismicStation> stations = makeStations(n);
+    LatencyRecorder latency;
+    EpicenterResult result;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        result = locator.locateEpicenter(stations, CALIFORNIA, ExecPolicy::serial);
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(result);
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.reportEvents(state);
+    state.counters["location_error"] = TRUE_EPICENTER.distance(result.location);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Full in-place locate of range(0) stations with a compile-time base case
+// size; compares leaf/recursion trade-offs against the default of 8
+template <int BaseCaseSize>
+static void BM_LocateBaseCase(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    LocatorConfig config;
+    config.partition_mode = PartitionMode::in_place;
+    BasicEpicenterLocator<BaseCaseSize> locator(config);
+    vector<SeismicStation> stations = makeStations(n);
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        EpicenterResult result = locator.locateEpicenter(stations, CALIFORNIA, ExecPolicy::serial);
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(result);
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.reportEvents(state);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Gauss-Newton refinement of a located estimate over range(0) stations with
+// kernel set range(1); the iteration count is reported as a counter
+static void BM_Refine(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    const auto& available = TriangulationKernels::available();
+    size_t kernel_index = static_cast<size_t>(state.range(1));
+    if (kernel_index >= available.size()) {
+        state.SkipWithError("kernel set not supported on this CPU");
+        return;
+    }
+    state.SetLabel(available[kernel_index]->name);
+    
+    LocatorConfig config;
+    config.kernels = available[kernel_index];
+    EarthquakeEpicenterLocator locator(config);
+    vector<SeismicStation> generated = makeStations(n);
+    StationSet stations(generated);
+    EpicenterResult initial = locator.locateEpicenter(generated, CALIFORNIA);
+    RefineReport report;
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        EpicenterResult result = locator.refineEpicenter(stations.view(), initial, &report);
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(result);
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.report(state);
+    state.counters["iterations"] = report.iterations;
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Batch locate of range(1) events against a prebuilt network of range(0) stations
+static void BM_BatchLocate(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    size_t num_events = static_cast<size_t>(state.range(1));
+    vector<SeismicStation> stations = makeStations(n);
+    StationNetwork network(stations, CALIFORNIA);
+    vector<ArrivalVector> events(num_events, ArrivalVector(n));
+    for (size_t e = 0; e < num_events; e++) {
+        for (const auto& station : stations) {
+            events[e][station.id] = station.detection_time + 0.01 * e;
+        }
+    }
+    EarthquakeEpicenterLocator locator;
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        vector<EpicenterResult> results = locator.locateEpicenters(network, Span<const ArrivalVector>(events));
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(results.data());
+        latency.add(start, end, num_events);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.reportEvents(state);
+    state.SetItemsProcessed(state.iterations() * num_events);
+}
+
+// BM_BatchLocate through the HostBackend offload path: range(2) = 0 on the
+// calling thread, 1 with each launch spread over a pool
+static void BM_BackendLocate(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    size_t num_events = static_cast<size_t>(state.range(1));
+    vector<SeismicStation> stations = makeStations(n);
+    StationNetwork network(stations, CALIFORNIA);
+    vector<ArrivalVector> events(num_events, ArrivalVector(n));
+    for (size_t e = 0; e < num_events; e++) {
+        for (const auto& station : stations) {
+            events[e][station.id] = station.detection_time + 0.01 * e;
+        }
+    }
+    WorkStealingPool pool;
+    HostBackend backend(state.range(2) ? &pool : nullptr);
+    LocatorConfig config;
+    config.backend = &backend;
+    EarthquakeEpicenterLocator locator(config);
+    LatencyRecorder latency;
+    BatchReport report;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        vector<EpicenterResult> results = locator.locateEpicenters(network, Span<const ArrivalVector>(events),
+                                                                   ExecPolicy::serial, &report);
+        auto end = steady_clock::now();
+        if (report.fell_back) {
+            state.SkipWithError(("backend fell back: " + report.backend_error).c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(results.data());
+        latency.add(start, end, num_events);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.reportEvents(state);
+    state.SetItemsProcessed(state.iterations() * num_events);
+}
+
+// One event against a prebuilt network of range(0) stations: range(1) = 0
+// uncached, 1 replayed through a warm NodeResultCache, 2 re-located after a
+// late pick changes one station per call
+static void BM_CachedLocate(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    int scenario = static_cast<int>(state.range(1));
+    vector<SeismicStation> stations = makeStations(n);
+    StationNetwork network(stations, CALIFORNIA);
+    vector<ArrivalVector> events(1, ArrivalVector(n));
+    for (const auto& station : stations) {
+        events[0][station.id] = station.detection_time;
+    }
+    NodeResultCache cache;
+    LocatorConfig config;
+    config.result_cache = scenario > 0 ? &cache : nullptr;
+    EarthquakeEpicenterLocator locator(config);
+    locator.locateEpicenters(network, Span<const ArrivalVector>(events));
+    cache.resetStats();
+    LatencyRecorder latency;
+    size_t late = 0;
+
+    for (auto _ : state) {
+        if (scenario == 2) {
+            events[0][late % n] += 0.25;
+            late++;
+        }
+        auto start = steady_clock::now();
+        vector<EpicenterResult> results = locator.locateEpicenters(network, Span<const ArrivalVector>(events));
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(results.data());
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.reportEvents(state);
+    NodeResultCache::Stats stats = cache.stats();
+    state.counters["hit_rate"] = stats.hits + stats.misses > 0 
+        ? static_cast<double>(stats.hits) / (stats.hits + stats.misses) : 0.0;
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Startup of a range(0)-station StationNetwork: range(1) = 0 builds it from
+// the stations, 1 restores it from a NetworkSnapshot written beforehand
+static void BM_NetworkStartup(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    bool restore = state.range(1) != 0;
+    state.SetLabel(restore ? "snapshot" : "build");
+    vector<SeismicStation> stations = makeStations(n);
+    const string path = "bm_snapshot.tmp";
+    if (restore) {
+        NetworkSnapshot::write(path, StationNetwork(stations, CALIFORNIA), 1);
+    }
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        if (restore) {
+            NetworkSnapshot snapshot;
+            snapshot.open(path, 1);
+            benchmark::DoNotOptimize(snapshot.network().size());
+        } else {
+            StationNetwork network(stations, CALIFORNIA);
+            benchmark::DoNotOptimize(network.size());
+        }
+        auto end = steady_clock::now();
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    remove(path.c_str());
+    latency.report(state);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// BM_BatchLocate's workload scattered over range(2) loopback nodes with
+// tiles at depth 3; the difference is the wire format and the gather
+static void BM_DistributedLocate(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    size_t num_events = static_cast<size_t>(state.range(1));
+    vector<SeismicStation> stations = makeStations(n);
+    StationNetwork network(stations, CALIFORNIA);
+    vector<ArrivalVector> events(num_events, ArrivalVector(n));
+    for (size_t e = 0; e < num_events; e++) {
+        for (const auto& station : stations) {
+            events[e][station.id] = station.detection_time + 0.01 * e;
+        }
+    }
+    LoopbackTransport transport(static_cast<size_t>(state.range(2)));
+    DistributedNetwork distributed(network, transport, 3);
+    string error;
+    if (!distributed.distribute(&error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    vector<EpicenterResult> results;
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        distributed.locate(Span<const ArrivalVector>(events), results);
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(results.data());
+        latency.add(start, end, num_events);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.reportEvents(state);
+    state.SetItemsProcessed(state.iterations() * num_events);
+}
+
+// Synthetic network of range(0) stations, clustered when range(2) is set,
+// serial (range(1) = 0) or on a range(1)-thread pool; the chained generator
+// is the old per-station random_device path
+static void BM_Generate(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    size_t num_threads = static_cast<size_t>(state.range(1));
+    NetworkScenario scenario(n, CALIFORNIA);
+    scenario.epicenters.assign(1, TRUE_EPICENTER);
+    scenario.num_clusters = state.range(2) ? 16 : 0;
+    unique_ptr<WorkStealingPool> pool(num_threads ? new WorkStealingPool(num_threads) : nullptr);
+    StationSet stations;
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        SyntheticNetwork::generate(scenario, 42, stations, pool.get());
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(stations.detection_time.data());
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.report(state);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_GenerateLegacy(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        vector<SeismicStation> stations = makeStations(n);
+        auto end = steady_clock::now();
+        benchmark::DoNotOptimize(stations.data());
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    latency.report(state);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Writes range(0) results in batches of 1000 through range(1): 0 = the
+// ofstream << rows runComplexityAnalysis used to write, 1 = CsvResultSink,
+// 2 = ColumnarResultSink, 3 = AsyncResultSink over a ColumnarResultSink.
+// The time is what the producer spends in write() and close(); for the
+// async sink, "producer_ms" is the write() calls alone.
+static void BM_WriteResults(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    int kind = static_cast<int>(state.range(1));
+    vector<EpicenterResult> results(n);
+    mt19937_64 rng(7);
+    uniform_real_distribution<double> lat(32.0, 42.0), lon(-125.0, -114.0), unit(0.0, 1.0);
+    for (EpicenterResult& r : results) {
+        r = EpicenterResult(Point(lat(rng), lon(rng)), unit(rng), unit(rng));
+    }
+    const string path = "bm_results.tmp";
+    const size_t BATCH = 1000;
+    LatencyRecorder latency;
+    double producer_ms = 0;
+
+    for (auto _ : state) {
+        auto start = steady_clock::now();
+        if (kind == 0) {
+            ofstream file(path);
+            for (size_t i = 0; i < n; i++) {
+                file << i << "," << results[i].location.x << "," << results[i].location.y << ","
+                     << results[i].confidence << "," << results[i].error << "\n";
+            }
+        } else {
+            CsvResultSink csv;
+            ColumnarResultSink columnar;
+            ResultSink* sink = &columnar;
+            if (kind == 1) {
+                csv.open(path);
+                sink = &csv;
+            } else {
+                columnar.open(path);
+            }
+            unique_ptr<AsyncResultSink> async(kind == 3 ? new AsyncResultSink(columnar) : nullptr);
+            if (async) {
+                sink = async.get();
+            }
+            for (size_t i = 0; i < n; i += BATCH) {
+                sink->write(Span<const EpicenterResult>(results.data() + i, min(BATCH, n - i)));
+            }
+            producer_ms += duration<double, milli>(steady_clock::now() - start).count();
+            sink->close();
+        }
+        auto end = steady_clock::now();
+        latency.add(start, end);
+        state.SetIterationTime(duration<double>(end - start).count());
+    }
+    remove(path.c_str());
+    latency.report(state);
+    if (kind == 3) {
+        state.counters["producer_ms"] = producer_ms / state.iterations();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void kernelArgs(benchmark::internal::Benchmark* b) {
+    for (int64_t kernel = 0; kernel < static_cast<int64_t>(TriangulationKernels::available().size()); kernel++) {
+        for (int64_t leaf_size : {2, 4, 6, 8, 16, 64}) {
+            b->Args({kernel, leaf_size, 0});
+            b->Args({kernel, leaf_size, 1});
+            if (leaf_size <= static_cast<int64_t>(MAX_FIXED_LEAF)) {
+                b->Args({kernel, leaf_size, 2});
+            }
+        }
+    }
+}
+
+static void residualArgs(benchmark::internal::Benchmark* b) {
+    for (int64_t kernel = 0; kernel < static_cast<int64_t>(TriangulationKernels::available().size()); kernel++) {
+        for (int64_t n : {4096, 1 << 20}) {
+            b->Args({kernel, n, 0});
+            b->Args({kernel, n, 1});
+        }
+    }
+}
+
+static void pruneArgs(benchmark::internal::Benchmark* b) {
+    for (int64_t n : {10000, 1000000}) {
+        b->Args({n, 0, 10});
+        for (int64_t mode : {1, 2}) {
+            for (int64_t tenths : {10, 5, 0}) {
+                b->Args({n, mode, tenths});
+            }
+        }
+    }
+}
+
+static void refineArgs(benchmark::internal::Benchmark* b) {
+    for (int64_t kernel = 0; kernel < static_cast<int64_t>(TriangulationKernels::available().size()); kernel++) {
+        for (int64_t n = 1000; n <= 1000000; n *= 10) {
+            b->Args({n, kernel});
+        }
+    }
+}
+
+static void scalingArgs(benchmark::internal::Benchmark* b) {
+    for (int64_t threads = 1; threads <= 8; threads *= 2) {
+        b->Args({1000000, threads, 0});
+        b->Args({250000, threads, 1});
+    }
+}
+
+static void locateArgs(benchmark::internal::Benchmark* b) {
+    for (int64_t n = 100; n <= 1000000; n *= 10) {
+        b->Args({n, 0, 0});
+        b->Args({n, 1, 0});
+        b->Args({n, 1, 1});
+        b->Args({n, 2, 0});
+    }
+}
+
+BENCHMARK(BM_Partition)->RangeMultiplier(10)->Range(100, 1000000)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LeafTriangulation)->Apply(kernelArgs)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_Residuals)->Apply(residualArgs)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Combine)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_MergeSummaries)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_Locate)->Apply(locateArgs)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LocateScaling)->Apply(scalingArgs)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+#ifdef EARTHQUAKE_COROUTINES
+BENCHMARK(BM_LocateAsync)->Arg(100000)->Arg(1000000)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+#endif
+BENCHMARK(BM_LocatePrecision)->ArgsProduct({{10000, 100000, 1000000}, {0, 1}})
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LocateEngine)->ArgsProduct({{1000, 100000, 1000000}, {0, 1}})
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LocatePruned)->Apply(pruneArgs)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_LocateBaseCase, 4)->Arg(100000)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_LocateBaseCase, 8)->Arg(100000)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_LocateBaseCase, 16)->Arg(100000)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Refine)->Apply(refineArgs)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BackendLocate)->ArgsProduct({{10000, 100000}, {64}, {0, 1}})
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CachedLocate)->ArgsProduct({{10000, 100000}, {0, 1, 2}})
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_NetworkStartup)->ArgsProduct({{100000, 1000000}, {0, 1}})
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DistributedLocate)->ArgsProduct({{10000, 100000}, {64}, {1, 4}})
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Generate)->ArgsProduct({{100000, 1000000}, {0, 4}, {0, 1}})
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GenerateLegacy)->Arg(100000)->Arg(1000000)
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_WriteResults)->ArgsProduct({{100000, 1000000}, {0, 1, 2, 3}})
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BatchLocate)->Args({10000, 64})->Args({100000, 64})
+    ->UseManualTime()->MinWarmUpTime(0.1)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    addBuildContext();
+    AllocationCounter allocations;
+    benchmark::RegisterMemoryManager(&allocations);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::RegisterMemoryManager(nullptr);
+    benchmark::Shutdown();
+    return 0;
+}
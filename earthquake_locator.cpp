@@ -6,6 +6,58 @@
 #include <algorithm>
 #include <fstream>
 #include <iomanip>
+#include <limits>
+#include <unordered_map>
+#include <list>
+#include <new>
+#include <string>
+#include <array>
+#include <charconv>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <mutex>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+
+// C++20 builds also get the coroutine locate API (locateAsync)
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#include <stop_token>
+#define EARTHQUAKE_COROUTINES 1
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define EQ_X86_DISPATCH 1
+#else
+#define EQ_X86_DISPATCH 0
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define EQ_NEON 1
+#else
+#define EQ_NEON 0
+#endif
 
 using namespace std;
 using namespace chrono;
@@ -32,10 +84,38 @@ struct Point {
     }
 };
 
+// Non-owning view over a contiguous range of elements (std::span is C++20)
+template <typename T>
+struct Span {
+    T* items;
+    size_t count;
+    
+    Span() : items(nullptr), count(0) {}
+    Span(T* _items, size_t _count) : items(_items), count(_count) {}
+    
+    template <typename Container>
+    Span(Container& container) : items(container.data()), count(container.size()) {}
+    
+    T* data() const { return items; }
+    T* begin() const { return items; }
+    T* end() const { return items + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T& operator[](size_t i) const { return items[i]; }
+    
+    Span subspan(size_t offset, size_t length) const {
+        return Span(items + offset, length);
+    }
+};
+
+typedef Span<SeismicStation> StationSpan;
+
 // Geographic bounds for spatial partitioning
 struct GeoBounds {
     double min_lat, max_lat, min_lon, max_lon;
     
+    GeoBounds() : min_lat(0), max_lat(0), min_lon(0), max_lon(0) {}
+    
     GeoBounds(double minLat, double maxLat, double minLon, double maxLon) 
         : min_lat(minLat), max_lat(maxLat), min_lon(minLon), max_lon(maxLon) {}
     
@@ -44,15 +124,25 @@ struct GeoBounds {
     }
     
     bool contains(const SeismicStation& station) const {
-        return station.latitude >= min_lat && station.latitude <= max_lat &&
-               station.longitude >= min_lon && station.longitude <= max_lon;
+        return contains(station.latitude, station.longitude);
+    }
+    
+    bool contains(double lat, double lon) const {
+        return lat >= min_lat && lat <= max_lat &&
+               lon >= min_lon && lon <= max_lon;
+    }
+    
+    // Same test without short-circuiting, for branch-free loops
+    unsigned containsBit(double lat, double lon) const {
+        return unsigned(lat >= min_lat) & unsigned(lat <= max_lat) &
+               unsigned(lon >= min_lon) & unsigned(lon <= max_lon);
     }
 };
 
-// Quadrant for spatial division
+// Quadrant for spatial division (views stations owned by the caller)
 struct Quadrant {
     GeoBounds bounds;
-    vector<SeismicStation> stations;
+    StationSpan stations;
     Point estimate;
     double confidence;
     
@@ -65,237 +155,7590 @@ struct EpicenterResult {
     double confidence;
     double error;
     
+    // Default result means "no estimate" (same as locating zero stations)
+    EpicenterResult() : location(0, 0), confidence(0), error(1e9) {}
+    
     EpicenterResult(Point loc, double conf, double err) 
         : location(loc), confidence(conf), error(err) {}
 };
 
-// Earthquake Epicenter Locator using Divide & Conquer
-class EarthquakeEpicenterLocator {
-private:
-    static const int BASE_CASE_SIZE = 8;  // Threshold for base case
-    static const double WAVE_VELOCITY;   // km/s (P-wave velocity)
+// Mergeable sufficient statistics of a set of leaves. Each station keeps
+// the inverse-time weight w of its leaf's simpleTriangulation; the summary
+// holds the station and leaf counts, the earliest arrival and the weighted
+// moments of latitude, longitude and arrival time up to second order, with
+// times taken from min_arrival. merge is O(1) and exact up to rounding
+// (times are rebased onto the earlier min_arrival), so summaries can be
+// cached per node, updated along one root path, reduced in any order and
+// shipped between processes.
+//
+// result() is the pooled weighted centroid. Its residual is the weighted
+// misfit of the arrival times against the best planar moveout through the
+// stations, t = t0 + g . (s - centroid), which the moments give exactly
+// for any grouping of the leaves. confidence is 1 / (1 + mean squared
+// residual per unit weight), and error is that mean times the stations per
+// leaf: a leaf's residual sum, the scale of weightedCombination's
+// confidence-weighted mean of leaf errors. A one-leaf summary has
+// simpleTriangulation's center; leafResult() adds its straight-ray error.
+struct EpicenterSummary {
+    size_t count;              // Stations (with picks)
+    size_t leaves;             // Leaves with at least one pick
+    double weight;             // Sum of inverse-time weights
+    double weighted_lat;       // Sum of weight * latitude
+    double weighted_lon;       // Sum of weight * longitude
+    double min_arrival;        // Earliest detection, +inf when empty
+    double weighted_time;      // Sum of weight * (time - min_arrival)
+    double lat_lat;            // Second moments: sums of weight * product
+    double lat_lon;
+    double lon_lon;
+    double lat_time;
+    double lon_time;
+    double time_time;
     
-public:
-    // Main divide and conquer algorithm
-    EpicenterResult locateEpicenter(vector<SeismicStation>& stations, 
-                                   const GeoBounds& bounds, 
-                                   int depth = 0) {
-        
-        // Base case: use simple triangulation
-        if (stations.size() <= BASE_CASE_SIZE) {
-            return simpleTriangulation(stations);
-        }
-        
-        // Divide: Split geographic region into quadrants
-        double mid_lat = (bounds.min_lat + bounds.max_lat) / 2;
-        double mid_lon = (bounds.min_lon + bounds.max_lon) / 2;
-        
-        vector<Quadrant> quadrants = {
-            Quadrant(GeoBounds(bounds.min_lat, mid_lat, bounds.min_lon, mid_lon)), // SW
-            Quadrant(GeoBounds(bounds.min_lat, mid_lat, mid_lon, bounds.max_lon)),  // SE
-            Quadrant(GeoBounds(mid_lat, bounds.max_lat, bounds.min_lon, mid_lon)),  // NW
-            Quadrant(GeoBounds(mid_lat, bounds.max_lat, mid_lon, bounds.max_lon))   // NE
-        };
-        
-        // Partition stations into quadrants
-        for (auto& station : stations) {
-            for (auto& quad : quadrants) {
-                if (quad.bounds.contains(station)) {
-                    quad.stations.push_back(station);
-                    break;
-                }
-            }
-        }
-        
-        // Recursively solve for each quadrant with stations
-        vector<EpicenterResult> results;
-        for (auto& quad : quadrants) {
-            if (!quad.stations.empty()) {
-                EpicenterResult result = locateEpicenter(quad.stations, quad.bounds, depth + 1);
-                quad.estimate = result.location;
-                quad.confidence = result.confidence;
-                results.push_back(result);
-            }
-        }
-        
-        // Combine: Weighted average of regional estimates
-        return weightedCombination(results);
+    EpicenterSummary() 
+        : count(0), leaves(0), weight(0), weighted_lat(0), weighted_lon(0),
+          min_arrival(numeric_limits<double>::infinity()), weighted_time(0), 
+          lat_lat(0), lat_lon(0), lon_lon(0), lat_time(0), lon_time(0), time_time(0) {}
+    
+    bool empty() const { return count == 0; }
+    
+    // Second moments of one station, time relative to min_arrival; the
+    // first-order sums come from the centroid kernels
+    void addMoments(double lat, double lon, double time, double w) {
+        weighted_time += w * time;
+        lat_lat += w * lat * lat;
+        lat_lon += w * lat * lon;
+        lon_lon += w * lon * lon;
+        lat_time += w * lat * time;
+        lon_time += w * lon * time;
+        time_time += w * time * time;
     }
     
-private:
-    // Simple triangulation for base case
-    EpicenterResult simpleTriangulation(const vector<SeismicStation>& stations) {
-        if (stations.empty()) {
-            return EpicenterResult(Point(0, 0), 0, 1e9);
-        }
-        
-        if (stations.size() == 1) {
-            return EpicenterResult(Point(stations[0].latitude, stations[0].longitude), 1.0, 0);
-        }
-        
-        // Use geometric approach: intersection of circles
-        // For simplicity, use least squares method
-        double sum_x = 0, sum_y = 0;
-        double min_time = stations[0].detection_time;
-        
-        // Find minimum detection time (closest to epicenter)
-        for (const auto& station : stations) {
-            min_time = min(min_time, station.detection_time);
+    EpicenterSummary& merge(const EpicenterSummary& other) {
+        if (other.empty()) {
+            return *this;
         }
-        
-        // Calculate weighted center based on time differences
-        double total_weight = 0;
-        for (const auto& station : stations) {
-            double time_diff = station.detection_time - min_time;
-            double weight = 1.0 / (1.0 + time_diff * time_diff); // Inverse time weighting
-            
-            sum_x += station.latitude * weight;
-            sum_y += station.longitude * weight;
-            total_weight += weight;
+        if (empty()) {
+            return *this = other;
         }
-        
-        Point estimated_center(sum_x / total_weight, sum_y / total_weight);
-        
-        // Calculate error (sum of squared residuals)
-        double error = 0;
-        for (const auto& station : stations) {
-            double distance = estimated_center.distance(Point(station.latitude, station.longitude));
-            double theoretical_time = distance / WAVE_VELOCITY;
-            double actual_time = station.detection_time - min_time;
-            error += (theoretical_time - actual_time) * (theoretical_time - actual_time);
+        EpicenterSummary rebased = other;
+        if (other.min_arrival < min_arrival) {
+            rebase(other.min_arrival);
+        } else {
+            rebased.rebase(min_arrival);
         }
-        
-        double confidence = 1.0 / (1.0 + error / stations.size());
-        return EpicenterResult(estimated_center, confidence, error);
+        count += rebased.count;
+        leaves += rebased.leaves;
+        weight += rebased.weight;
+        weighted_lat += rebased.weighted_lat;
+        weighted_lon += rebased.weighted_lon;
+        weighted_time += rebased.weighted_time;
+        lat_lat += rebased.lat_lat;
+        lat_lon += rebased.lat_lon;
+        lon_lon += rebased.lon_lon;
+        lat_time += rebased.lat_time;
+        lon_time += rebased.lon_time;
+        time_time += rebased.time_time;
+        return *this;
     }
     
-    // Weighted combination of multiple estimates
-    EpicenterResult weightedCombination(const vector<EpicenterResult>& results) {
-        if (results.empty()) {
-            return EpicenterResult(Point(0, 0), 0, 1e9);
+    // Weighted sum of squared residuals about the planar moveout fit. With
+    // the stations on one line (or one point) the fit drops to that line's
+    // direction (or to the mean time).
+    double residual() const {
+        if (count == 0 || !(weight > 0)) {
+            return 0;
         }
-        
-        if (results.size() == 1) {
-            return results[0];
+        double lat = weighted_lat / weight, lon = weighted_lon / weight, time = weighted_time / weight;
+        double xx = lat_lat - weighted_lat * lat, xy = lat_lon - weighted_lat * lon;
+        double yy = lon_lon - weighted_lon * lon;
+        double xt = lat_time - weighted_lat * time, yt = lon_time - weighted_lon * time;
+        double tt = time_time - weighted_time * time;
+        double det = xx * yy - xy * xy;
+        double explained = 0;
+        if (det > 1e-12 * xx * yy && det > 0) {
+            explained = (yy * xt * xt - 2 * xy * xt * yt + xx * yt * yt) / det;
+        } else if (xx >= yy && xx > 0) {
+            explained = xt * xt / xx;
+        } else if (yy > 0) {
+            explained = yt * yt / yy;
         }
-        
-        double total_weight = 0;
-        double weighted_x = 0, weighted_y = 0;
-        double combined_error = 0;
-        
-        for (const auto& result : results) {
-            double weight = result.confidence;
-            weighted_x += result.location.x * weight;
-            weighted_y += result.location.y * weight;
-            total_weight += weight;
-            combined_error += result.error * weight;
+        return max(tt - explained, 0.0);
+    }
+    
+    EpicenterResult result() const {
+        if (count == 0) {
+            return EpicenterResult();
         }
-        
-        Point combined_location(weighted_x / total_weight, weighted_y / total_weight);
-        double combined_confidence = total_weight / results.size();
-        
-        return EpicenterResult(combined_location, combined_confidence, combined_error / total_weight);
+        double mean_square = weight > 0 ? residual() / weight : 0;
+        double confidence = 1.0 / (1.0 + mean_square);
+        double stations_per_leaf = static_cast<double>(count) / static_cast<double>(max(leaves, size_t(1)));
+        return EpicenterResult(Point(weighted_lat / weight, weighted_lon / weight), confidence, 
+                               mean_square * stations_per_leaf);
     }
     
-public:
-    // Generate synthetic earthquake data
-    static vector<SeismicStation> generateEarthquakeData(int num_stations, 
-                                                        Point true_epicenter,
-                                                        const GeoBounds& region) {
-        vector<SeismicStation> stations;
-        random_device rd;
-        mt19937 gen(rd());
-        uniform_real_distribution<> lat_dist(region.min_lat, region.max_lat);
-        uniform_real_distribution<> lon_dist(region.min_lon, region.max_lon);
-        uniform_real_distribution<> noise_dist(-0.5, 0.5); // Time noise
-        
-        for (int i = 0; i < num_stations; i++) {
-            double lat = lat_dist(gen);
-            double lon = lon_dist(gen);
-            
-            // Calculate theoretical arrival time
-            double distance = true_epicenter.distance(Point(lat, lon));
-            double travel_time = distance / WAVE_VELOCITY;
-            double detected_time = travel_time + noise_dist(gen); // Add noise
-            
-            stations.emplace_back(i, lat, lon, detected_time);
+    // simpleTriangulation's result for a one-leaf summary, given the leaf's
+    // straight-ray squared residuals
+    EpicenterResult leafResult(double squared_residuals) const {
+        if (count == 0) {
+            return EpicenterResult();
         }
-        
-        return stations;
+        return EpicenterResult(Point(weighted_lat / weight, weighted_lon / weight), 
+                               1.0 / (1.0 + squared_residuals / count), squared_residuals);
     }
     
-    // Performance testing
-    static double measureExecutionTime(EarthquakeEpicenterLocator& locator,
-                                      vector<SeismicStation>& stations,
-                                      const GeoBounds& bounds) {
-        auto start = high_resolution_clock::now();
-        locator.locateEpicenter(stations, bounds);
-        auto end = high_resolution_clock::now();
-        
-        auto duration = duration_cast<microseconds>(end - start);
-        return duration.count() / 1000.0; // Convert to milliseconds
+private:
+    // Re-expresses the time moments relative to an earlier min_arrival
+    void rebase(double new_min) {
+        double shift = min_arrival - new_min;
+        time_time += 2 * shift * weighted_time + shift * shift * weight;
+        lat_time += shift * weighted_lat;
+        lon_time += shift * weighted_lon;
+        weighted_time += shift * weight;
+        min_arrival = new_min;
     }
+};
+
+// Allocator for 64-byte aligned arrays (one cache line, one AVX-512 register)
+template <typename T, size_t Alignment = 64>
+struct AlignedAllocator {
+    typedef T value_type;
     
-    // Complexity analysis
-    static void runComplexityAnalysis() {
-        cout << "\n=== DIVIDE & CONQUER COMPLEXITY ANALYSIS ===\n";
-        cout << "Testing earthquake epicenter location with varying station counts...\n";
-        cout << "Format: Stations, Time(ms), Error, Estimated_Location\n\n";
-        
-        ofstream file("earthquake_results.csv");
-        file << "Stations,Time_ms,Error,Location_X,Location_Y\n";
-        
-        vector<int> test_sizes = {25, 50, 100, 200, 500, 1000, 1500, 2000};
-        Point true_epicenter(35.0, -120.0); // California coordinates
-        GeoBounds california(32.0, 42.0, -125.0, -114.0); // California region
-        
-        for (int n : test_sizes) {
-            double total_time = 0.0;
-            double total_error = 0.0;
-            Point avg_location(0, 0);
-            int trials = 5;
-            
-            for (int trial = 0; trial < trials; trial++) {
-                EarthquakeEpicenterLocator locator;
-                vector<SeismicStation> stations = generateEarthquakeData(n, true_epicenter, california);
-                
-                double exec_time = measureExecutionTime(locator, stations, california);
-                EpicenterResult result = locator.locateEpicenter(stations, california);
-                
-                total_time += exec_time;
-                total_error += result.error;
-                avg_location.x += result.location.x;
-                avg_location.y += result.location.y;
-            }
-            
-            double avg_time = total_time / trials;
-            double avg_error = total_error / trials;
-            avg_location.x /= trials;
-            avg_location.y /= trials;
-            
-            double location_error = true_epicenter.distance(avg_location);
-            
-            cout << setw(8) << n 
-                 << setw(12) << fixed << setprecision(3) << avg_time
-                 << setw(12) << fixed << setprecision(6) << avg_error
-                 << setw(12) << fixed << setprecision(3) << location_error << " km"
-                 << " (" << fixed << setprecision(3) << avg_location.x 
-                 << ", " << avg_location.y << ")" << endl;
-            
-            file << n << "," << avg_time << "," << avg_error << "," 
-                 << avg_location.x << "," << avg_location.y << "\n";
+    template <typename U>
+    struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+    
+    AlignedAllocator() {}
+    
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+    
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), align_val_t(Alignment)));
+    }
+    
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, align_val_t(Alignment));
+    }
+    
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+template <typename T>
+using AlignedVector = vector<T, AlignedAllocator<T>>;
+
+// Non-owning structure-of-arrays view over a range of stations. Real is the
+// coordinate and time type: double, or float for the float32 mode.
+template <typename Real>
+struct BasicStationSetView {
+    const Real* latitude;
+    const Real* longitude;
+    const Real* detection_time;
+    const int* id;
+    size_t count;
+    
+    BasicStationSetView() 
+        : latitude(nullptr), longitude(nullptr), detection_time(nullptr), id(nullptr), count(0) {}
+    
+    BasicStationSetView(const Real* lat, const Real* lon, const Real* time, const int* _id, 
+                        size_t _count) 
+        : latitude(lat), longitude(lon), detection_time(time), id(_id), count(_count) {}
+    
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    
+    BasicStationSetView subview(size_t offset, size_t length) const {
+        return BasicStationSetView(latitude + offset, longitude + offset, detection_time + offset,
+                                   id + offset, length);
+    }
+};
+
+// Structure-of-arrays station storage: each field in its own aligned array so
+// the leaf kernels stream full cache lines of the values they actually use
+template <typename Real>
+struct BasicStationSet {
+    AlignedVector<Real> latitude;
+    AlignedVector<Real> longitude;
+    AlignedVector<Real> detection_time;
+    AlignedVector<int> id;
+    
+    BasicStationSet() {}
+    
+    explicit BasicStationSet(Span<const SeismicStation> stations) { assign(stations); }
+    
+    size_t size() const { return id.size(); }
+    bool empty() const { return id.empty(); }
+    
+    void resize(size_t n) {
+        latitude.resize(n);
+        longitude.resize(n);
+        detection_time.resize(n);
+        id.resize(n);
+    }
+    
+    // Replace contents; keeps existing capacity
+    void assign(Span<const SeismicStation> stations) {
+        resize(stations.size());
+        for (size_t i = 0; i < stations.size(); i++) {
+            latitude[i] = static_cast<Real>(stations[i].latitude);
+            longitude[i] = static_cast<Real>(stations[i].longitude);
+            detection_time[i] = static_cast<Real>(stations[i].detection_time);
+            id[i] = stations[i].id;
         }
-        
-        file.close();
-        cout << "\nResults saved to earthquake_results.csv\n";
-        cout << "True epicenter: (" << true_epicenter.x << ", " << true_epicenter.y << ")\n";
     }
+    
+    // Replace contents with a copy of a view (one pass per column, converting
+    // between precisions if needed)
+    template <typename Other>
+    void assign(const BasicStationSetView<Other>& stations) {
+        resize(stations.size());
+        copy(stations.latitude, stations.latitude + stations.size(), latitude.begin());
+        copy(stations.longitude, stations.longitude + stations.size(), longitude.begin());
+        copy(stations.detection_time, stations.detection_time + stations.size(), detection_time.begin());
+        copy(stations.id, stations.id + stations.size(), id.begin());
+    }
+    
+    void push_back(const SeismicStation& station) {
+        latitude.push_back(static_cast<Real>(station.latitude));
+        longitude.push_back(static_cast<Real>(station.longitude));
+        detection_time.push_back(static_cast<Real>(station.detection_time));
+        id.push_back(station.id);
+    }
+    
+    SeismicStation station(size_t i) const {
+        return SeismicStation(id[i], latitude[i], longitude[i], detection_time[i]);
+    }
+    
+    BasicStationSetView<Real> view() const { return view(0, size()); }
+    
+    BasicStationSetView<Real> view(size_t offset, size_t length) const {
+        return BasicStationSetView<Real>(latitude.data() + offset, longitude.data() + offset,
+                                         detection_time.data() + offset, id.data() + offset, length);
+    }
+};
+
+typedef BasicStationSetView<double> StationSetView;
+typedef BasicStationSet<double> StationSet;
+
+// Float32 storage: half the bytes per station and twice the SIMD lanes.
+// Coordinates keep about 0.5 m of precision; detection times should be
+// relative to a nearby reference (not epoch seconds) to keep sub-millisecond
+// resolution. The float kernels accumulate their reductions in double.
+typedef BasicStationSetView<float> FloatStationSetView;
+typedef BasicStationSet<float> FloatStationSet;
+
+// Travel times sampled on a regular grid of epicenter-station offsets, for
+// velocity models that are costly to evaluate per residual. Entry (i, j) is
+// the time over (i * step_lat, j * step_lon) degrees; the model is assumed
+// symmetric, so lookups use the absolute offset and interpolate bilinearly.
+// Offsets past the last row or column extrapolate from the edge cell.
+// Non-owning; TravelTimeGrid builds, stores and maps the values.
+struct TravelTimeTable {
+    const double* times;    // rows x cols, row-major
+    size_t rows, cols;      // Both at least 2
+    double inv_step_lat;    // 1 / step_lat
+    double inv_step_lon;
+    
+    double travelTime(double delta_lat, double delta_lon) const {
+        double fi = fabs(delta_lat) * inv_step_lat;
+        double fj = fabs(delta_lon) * inv_step_lon;
+        double last_row = static_cast<double>(rows - 2);
+        double last_col = static_cast<double>(cols - 2);
+        double i = floor(fi) < last_row ? floor(fi) : last_row;  // NaN offsets clamp too
+        double j = floor(fj) < last_col ? floor(fj) : last_col;
+        double a = fi - i;
+        double b = fj - j;
+        const double* cell = times + static_cast<size_t>(i) * cols + static_cast<size_t>(j);
+        double near_row = cell[0] + (cell[1] - cell[0]) * b;
+        double far_row = cell[cols] + (cell[cols + 1] - cell[cols]) * b;
+        return near_row + (far_row - near_row) * a;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Leaf triangulation kernels over SoA arrays.
+// Each set implements the three passes of simpleTriangulation: minimum
+// detection time, inverse-time weighted centroid and squared travel-time
+// residuals (from the straight-ray model or a TravelTimeTable), plus the
+// normal equations of the Gauss-Newton refinement.
+// The widest set the CPU supports is picked once at runtime.
+// ---------------------------------------------------------------------------
+
+struct TriangulationKernels {
+    const char* name;
+    double (*minTime)(const double* time, size_t n);
+    // sums receives {sum(lat * w), sum(lon * w), sum(w)}
+    void (*weightedCentroid)(const double* lat, const double* lon, const double* time,
+                             size_t n, double min_time, double* sums);
+    double (*residualError)(const double* lat, const double* lon, const double* time,
+                            size_t n, double center_lat, double center_lon,
+                            double min_time, double velocity);
+    // residualError with the theoretical times interpolated from table
+    double (*residualErrorTable)(const double* lat, const double* lon, const double* time,
+                                 size_t n, double center_lat, double center_lon,
+                                 double min_time, const TravelTimeTable& table);
+    // Travel-time residual r = time - origin_time - distance / velocity and the
+    // gradient g = (gx, gy, 1) of the predicted arrival in (lat, lon, origin
+    // time), accumulated as sums = {gx*gx, gx*gy, gx, gy*gy, gy, gx*r, gy*r, r, r*r}
+    void (*normalEquations)(const double* lat, const double* lon, const double* time,
+                            size_t n, double center_lat, double center_lon,
+                            double origin_time, double velocity, double* sums);
+    // Leaves of up to this many stations run faster through the fixed-size
+    // solvers (triangulateFixed) than through this set; see fixed_size_leaves
+    size_t fixed_leaf_limit;
+    
+    static const vector<const TriangulationKernels*>& available();
+    static const TriangulationKernels& best();
+    static const TriangulationKernels* find(const string& name);
+};
+
+static double minTimeScalar(const double* time, size_t n) {
+    double min_time = time[0];
+    for (size_t i = 0; i < n; i++) {
+        min_time = min(min_time, time[i]);
+    }
+    return min_time;
+}
+
+static void weightedCentroidScalar(const double* lat, const double* lon, const double* time,
+                                   size_t n, double min_time, double* sums) {
+    double sum_x = 0, sum_y = 0, total_weight = 0;
+    for (size_t i = 0; i < n; i++) {
+        double time_diff = time[i] - min_time;
+        double weight = 1.0 / (1.0 + time_diff * time_diff);
+        sum_x += lat[i] * weight;
+        sum_y += lon[i] * weight;
+        total_weight += weight;
+    }
+    sums[0] = sum_x;
+    sums[1] = sum_y;
+    sums[2] = total_weight;
+}
+
+static double residualErrorScalar(const double* lat, const double* lon, const double* time,
+                                  size_t n, double center_lat, double center_lon,
+                                  double min_time, double velocity) {
+    double error = 0;
+    for (size_t i = 0; i < n; i++) {
+        double dx = center_lat - lat[i];
+        double dy = center_lon - lon[i];
+        double theoretical_time = sqrt(dx * dx + dy * dy) / velocity;
+        double actual_time = time[i] - min_time;
+        error += (theoretical_time - actual_time) * (theoretical_time - actual_time);
+    }
+    return error;
+}
+
+static double residualErrorTableScalar(const double* lat, const double* lon, const double* time,
+                                       size_t n, double center_lat, double center_lon,
+                                       double min_time, const TravelTimeTable& table) {
+    double error = 0;
+    for (size_t i = 0; i < n; i++) {
+        double theoretical_time = table.travelTime(center_lat - lat[i], center_lon - lon[i]);
+        double actual_time = time[i] - min_time;
+        error += (theoretical_time - actual_time) * (theoretical_time - actual_time);
+    }
+    return error;
+}
+
+static void normalEquationsScalar(const double* lat, const double* lon, const double* time,
+                                  size_t n, double center_lat, double center_lon,
+                                  double origin_time, double velocity, double* sums) {
+    double gxx = 0, gxy = 0, gx1 = 0, gyy = 0, gy1 = 0, gxr = 0, gyr = 0, r1 = 0, rr = 0;
+    for (size_t i = 0; i < n; i++) {
+        double dx = center_lat - lat[i];
+        double dy = center_lon - lon[i];
+        double dist = sqrt(dx * dx + dy * dy);
+        double r = time[i] - origin_time - dist / velocity;
+        // A station at the estimate has no defined direction; it only constrains the origin time
+        double scale = dist > 0 ? 1.0 / (dist * velocity) : 0.0;
+        double gx = dx * scale;
+        double gy = dy * scale;
+        gxx += gx * gx;
+        gxy += gx * gy;
+        gx1 += gx;
+        gyy += gy * gy;
+        gy1 += gy;
+        gxr += gx * r;
+        gyr += gy * r;
+        r1 += r;
+        rr += r * r;
+    }
+    double result[9] = {gxx, gxy, gx1, gyy, gy1, gxr, gyr, r1, rr};
+    copy(result, result + 9, sums);
+}
+
+static const TriangulationKernels SCALAR_KERNELS = {
+    "scalar", minTimeScalar, weightedCentroidScalar, residualErrorScalar, residualErrorTableScalar,
+    normalEquationsScalar, 7
 };
 
-// Static member definition
-const double EarthquakeEpicenterLocator::WAVE_VELOCITY = 6.0; // km/s
+#if EQ_X86_DISPATCH
+
+__attribute__((target("avx2,fma")))
+static double horizontalSumAvx2(__m256d v) {
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+__attribute__((target("avx2,fma")))
+static double minTimeAvx2(const double* time, size_t n) {
+    size_t i = 0;
+    double min_time = time[0];
+    if (n >= 4) {
+        __m256d vmin = _mm256_loadu_pd(time);
+        for (i = 4; i + 4 <= n; i += 4) {
+            vmin = _mm256_min_pd(vmin, _mm256_loadu_pd(time + i));
+        }
+        __m128d m = _mm_min_pd(_mm256_castpd256_pd128(vmin), _mm256_extractf128_pd(vmin, 1));
+        min_time = _mm_cvtsd_f64(_mm_min_sd(m, _mm_unpackhi_pd(m, m)));
+    }
+    for (; i < n; i++) {
+        min_time = min(min_time, time[i]);
+    }
+    return min_time;
+}
+
+__attribute__((target("avx2,fma")))
+static void weightedCentroidAvx2(const double* lat, const double* lon, const double* time,
+                                 size_t n, double min_time, double* sums) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d vmin = _mm256_set1_pd(min_time);
+    __m256d sx = _mm256_setzero_pd(), sy = _mm256_setzero_pd(), sw = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d dt = _mm256_sub_pd(_mm256_loadu_pd(time + i), vmin);
+        __m256d w = _mm256_div_pd(one, _mm256_fmadd_pd(dt, dt, one));
+        sx = _mm256_fmadd_pd(_mm256_loadu_pd(lat + i), w, sx);
+        sy = _mm256_fmadd_pd(_mm256_loadu_pd(lon + i), w, sy);
+        sw = _mm256_add_pd(sw, w);
+    }
+    double tail[3];
+    weightedCentroidScalar(lat + i, lon + i, time + i, n - i, min_time, tail);
+    sums[0] = horizontalSumAvx2(sx) + tail[0];
+    sums[1] = horizontalSumAvx2(sy) + tail[1];
+    sums[2] = horizontalSumAvx2(sw) + tail[2];
+}
+
+__attribute__((target("avx2,fma")))
+static double residualErrorAvx2(const double* lat, const double* lon, const double* time,
+                                size_t n, double center_lat, double center_lon,
+                                double min_time, double velocity) {
+    const __m256d vcx = _mm256_set1_pd(center_lat);
+    const __m256d vcy = _mm256_set1_pd(center_lon);
+    const __m256d vmin = _mm256_set1_pd(min_time);
+    const __m256d vvel = _mm256_set1_pd(velocity);
+    __m256d err = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d dx = _mm256_sub_pd(vcx, _mm256_loadu_pd(lat + i));
+        __m256d dy = _mm256_sub_pd(vcy, _mm256_loadu_pd(lon + i));
+        __m256d dist = _mm256_sqrt_pd(_mm256_fmadd_pd(dx, dx, _mm256_mul_pd(dy, dy)));
+        __m256d actual = _mm256_sub_pd(_mm256_loadu_pd(time + i), vmin);
+        __m256d diff = _mm256_sub_pd(_mm256_div_pd(dist, vvel), actual);
+        err = _mm256_fmadd_pd(diff, diff, err);
+    }
+    return horizontalSumAvx2(err) + residualErrorScalar(lat + i, lon + i, time + i, n - i,
+                                                        center_lat, center_lon, min_time, velocity);
+}
+
+// GCC 12's AVX2 gather and AVX-512 headers trip -Wmaybe-uninitialized on their own
+// undefined-vector placeholders (GCC bug 105593)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
 
-int main() {
+// Four gathers per lane group fetch the corners of each station's cell
+__attribute__((target("avx2,fma")))
+static double residualErrorTableAvx2(const double* lat, const double* lon, const double* time,
+                                     size_t n, double center_lat, double center_lon,
+                                     double min_time, const TravelTimeTable& table) {
+    const __m256d vcx = _mm256_set1_pd(center_lat);
+    const __m256d vcy = _mm256_set1_pd(center_lon);
+    const __m256d vmin = _mm256_set1_pd(min_time);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d inv_lat = _mm256_set1_pd(table.inv_step_lat);
+    const __m256d inv_lon = _mm256_set1_pd(table.inv_step_lon);
+    const __m256d last_row = _mm256_set1_pd(static_cast<double>(table.rows - 2));
+    const __m256d last_col = _mm256_set1_pd(static_cast<double>(table.cols - 2));
+    const __m256d vcols = _mm256_set1_pd(static_cast<double>(table.cols));
+    const double* t = table.times;
+    const double* t_far = table.times + table.cols;
+    __m256d err = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d fi = _mm256_mul_pd(_mm256_andnot_pd(sign, _mm256_sub_pd(vcx, _mm256_loadu_pd(lat + i))), inv_lat);
+        __m256d fj = _mm256_mul_pd(_mm256_andnot_pd(sign, _mm256_sub_pd(vcy, _mm256_loadu_pd(lon + i))), inv_lon);
+        __m256d row = _mm256_min_pd(_mm256_floor_pd(fi), last_row);
+        __m256d col = _mm256_min_pd(_mm256_floor_pd(fj), last_col);
+        __m256d a = _mm256_sub_pd(fi, row);
+        __m256d b = _mm256_sub_pd(fj, col);
+        __m128i cell = _mm256_cvttpd_epi32(_mm256_add_pd(_mm256_mul_pd(row, vcols), col));
+        __m256d t00 = _mm256_i32gather_pd(t, cell, 8);
+        __m256d t01 = _mm256_i32gather_pd(t + 1, cell, 8);
+        __m256d t10 = _mm256_i32gather_pd(t_far, cell, 8);
+        __m256d t11 = _mm256_i32gather_pd(t_far + 1, cell, 8);
+        __m256d near_row = _mm256_add_pd(t00, _mm256_mul_pd(_mm256_sub_pd(t01, t00), b));
+        __m256d far_row = _mm256_add_pd(t10, _mm256_mul_pd(_mm256_sub_pd(t11, t10), b));
+        __m256d theoretical = _mm256_add_pd(near_row, _mm256_mul_pd(_mm256_sub_pd(far_row, near_row), a));
+        __m256d diff = _mm256_sub_pd(theoretical, _mm256_sub_pd(_mm256_loadu_pd(time + i), vmin));
+        err = _mm256_fmadd_pd(diff, diff, err);
+    }
+    return horizontalSumAvx2(err) + residualErrorTableScalar(lat + i, lon + i, time + i, n - i,
+                                                             center_lat, center_lon, min_time, table);
+}
+
+__attribute__((target("avx2,fma")))
+static void normalEquationsAvx2(const double* lat, const double* lon, const double* time,
+                                size_t n, double center_lat, double center_lon,
+                                double origin_time, double velocity, double* sums) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d vcx = _mm256_set1_pd(center_lat);
+    const __m256d vcy = _mm256_set1_pd(center_lon);
+    const __m256d vt0 = _mm256_set1_pd(origin_time);
+    const __m256d vvel = _mm256_set1_pd(velocity);
+    __m256d acc[9];
+    for (auto& a : acc) {
+        a = zero;
+    }
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d dx = _mm256_sub_pd(vcx, _mm256_loadu_pd(lat + i));
+        __m256d dy = _mm256_sub_pd(vcy, _mm256_loadu_pd(lon + i));
+        __m256d dist = _mm256_sqrt_pd(_mm256_fmadd_pd(dx, dx, _mm256_mul_pd(dy, dy)));
+        __m256d r = _mm256_sub_pd(_mm256_sub_pd(_mm256_loadu_pd(time + i), vt0), _mm256_div_pd(dist, vvel));
+        __m256d scale = _mm256_and_pd(_mm256_cmp_pd(dist, zero, _CMP_GT_OQ),
+                                      _mm256_div_pd(one, _mm256_mul_pd(dist, vvel)));
+        __m256d gx = _mm256_mul_pd(dx, scale);
+        __m256d gy = _mm256_mul_pd(dy, scale);
+        acc[0] = _mm256_fmadd_pd(gx, gx, acc[0]);
+        acc[1] = _mm256_fmadd_pd(gx, gy, acc[1]);
+        acc[2] = _mm256_add_pd(acc[2], gx);
+        acc[3] = _mm256_fmadd_pd(gy, gy, acc[3]);
+        acc[4] = _mm256_add_pd(acc[4], gy);
+        acc[5] = _mm256_fmadd_pd(gx, r, acc[5]);
+        acc[6] = _mm256_fmadd_pd(gy, r, acc[6]);
+        acc[7] = _mm256_add_pd(acc[7], r);
+        acc[8] = _mm256_fmadd_pd(r, r, acc[8]);
+    }
+    normalEquationsScalar(lat + i, lon + i, time + i, n - i, center_lat, center_lon,
+                          origin_time, velocity, sums);
+    for (int k = 0; k < 9; k++) {
+        sums[k] += horizontalSumAvx2(acc[k]);
+    }
+}
+
+__attribute__((target("avx512f")))
+static double minTimeAvx512(const double* time, size_t n) {
+    size_t i = 0;
+    double min_time = time[0];
+    if (n >= 8) {
+        __m512d vmin = _mm512_loadu_pd(time);
+        for (i = 8; i + 8 <= n; i += 8) {
+            vmin = _mm512_min_pd(vmin, _mm512_loadu_pd(time + i));
+        }
+        min_time = _mm512_reduce_min_pd(vmin);
+    }
+    for (; i < n; i++) {
+        min_time = min(min_time, time[i]);
+    }
+    return min_time;
+}
+
+__attribute__((target("avx512f")))
+static void weightedCentroidAvx512(const double* lat, const double* lon, const double* time,
+                                   size_t n, double min_time, double* sums) {
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d vmin = _mm512_set1_pd(min_time);
+    __m512d sx = _mm512_setzero_pd(), sy = _mm512_setzero_pd(), sw = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d dt = _mm512_sub_pd(_mm512_loadu_pd(time + i), vmin);
+        __m512d w = _mm512_div_pd(one, _mm512_fmadd_pd(dt, dt, one));
+        sx = _mm512_fmadd_pd(_mm512_loadu_pd(lat + i), w, sx);
+        sy = _mm512_fmadd_pd(_mm512_loadu_pd(lon + i), w, sy);
+        sw = _mm512_add_pd(sw, w);
+    }
+    double tail[3];
+    weightedCentroidScalar(lat + i, lon + i, time + i, n - i, min_time, tail);
+    sums[0] = _mm512_reduce_add_pd(sx) + tail[0];
+    sums[1] = _mm512_reduce_add_pd(sy) + tail[1];
+    sums[2] = _mm512_reduce_add_pd(sw) + tail[2];
+}
+
+__attribute__((target("avx512f")))
+static double residualErrorAvx512(const double* lat, const double* lon, const double* time,
+                                  size_t n, double center_lat, double center_lon,
+                                  double min_time, double velocity) {
+    const __m512d vcx = _mm512_set1_pd(center_lat);
+    const __m512d vcy = _mm512_set1_pd(center_lon);
+    const __m512d vmin = _mm512_set1_pd(min_time);
+    const __m512d vvel = _mm512_set1_pd(velocity);
+    __m512d err = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d dx = _mm512_sub_pd(vcx, _mm512_loadu_pd(lat + i));
+        __m512d dy = _mm512_sub_pd(vcy, _mm512_loadu_pd(lon + i));
+        __m512d dist = _mm512_sqrt_pd(_mm512_fmadd_pd(dx, dx, _mm512_mul_pd(dy, dy)));
+        __m512d actual = _mm512_sub_pd(_mm512_loadu_pd(time + i), vmin);
+        __m512d diff = _mm512_sub_pd(_mm512_div_pd(dist, vvel), actual);
+        err = _mm512_fmadd_pd(diff, diff, err);
+    }
+    return _mm512_reduce_add_pd(err) + residualErrorScalar(lat + i, lon + i, time + i, n - i,
+                                                           center_lat, center_lon, min_time, velocity);
+}
+
+__attribute__((target("avx512f")))
+static double residualErrorTableAvx512(const double* lat, const double* lon, const double* time,
+                                       size_t n, double center_lat, double center_lon,
+                                       double min_time, const TravelTimeTable& table) {
+    const __m512d vcx = _mm512_set1_pd(center_lat);
+    const __m512d vcy = _mm512_set1_pd(center_lon);
+    const __m512d vmin = _mm512_set1_pd(min_time);
+    const __m512d inv_lat = _mm512_set1_pd(table.inv_step_lat);
+    const __m512d inv_lon = _mm512_set1_pd(table.inv_step_lon);
+    const __m512d last_row = _mm512_set1_pd(static_cast<double>(table.rows - 2));
+    const __m512d last_col = _mm512_set1_pd(static_cast<double>(table.cols - 2));
+    const __m512d vcols = _mm512_set1_pd(static_cast<double>(table.cols));
+    const double* t = table.times;
+    const double* t_far = table.times + table.cols;
+    __m512d err = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d fi = _mm512_mul_pd(_mm512_abs_pd(_mm512_sub_pd(vcx, _mm512_loadu_pd(lat + i))), inv_lat);
+        __m512d fj = _mm512_mul_pd(_mm512_abs_pd(_mm512_sub_pd(vcy, _mm512_loadu_pd(lon + i))), inv_lon);
+        __m512d row = _mm512_min_pd(_mm512_roundscale_pd(fi, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC), last_row);
+        __m512d col = _mm512_min_pd(_mm512_roundscale_pd(fj, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC), last_col);
+        __m512d a = _mm512_sub_pd(fi, row);
+        __m512d b = _mm512_sub_pd(fj, col);
+        __m256i cell = _mm512_cvttpd_epi32(_mm512_add_pd(_mm512_mul_pd(row, vcols), col));
+        __m512d t00 = _mm512_i32gather_pd(cell, t, 8);
+        __m512d t01 = _mm512_i32gather_pd(cell, t + 1, 8);
+        __m512d t10 = _mm512_i32gather_pd(cell, t_far, 8);
+        __m512d t11 = _mm512_i32gather_pd(cell, t_far + 1, 8);
+        __m512d near_row = _mm512_add_pd(t00, _mm512_mul_pd(_mm512_sub_pd(t01, t00), b));
+        __m512d far_row = _mm512_add_pd(t10, _mm512_mul_pd(_mm512_sub_pd(t11, t10), b));
+        __m512d theoretical = _mm512_add_pd(near_row, _mm512_mul_pd(_mm512_sub_pd(far_row, near_row), a));
+        __m512d diff = _mm512_sub_pd(theoretical, _mm512_sub_pd(_mm512_loadu_pd(time + i), vmin));
+        err = _mm512_fmadd_pd(diff, diff, err);
+    }
+    return _mm512_reduce_add_pd(err) + residualErrorTableScalar(lat + i, lon + i, time + i, n - i,
+                                                                center_lat, center_lon, min_time, table);
+}
+
+__attribute__((target("avx512f")))
+static void normalEquationsAvx512(const double* lat, const double* lon, const double* time,
+                                  size_t n, double center_lat, double center_lon,
+                                  double origin_time, double velocity, double* sums) {
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d vcx = _mm512_set1_pd(center_lat);
+    const __m512d vcy = _mm512_set1_pd(center_lon);
+    const __m512d vt0 = _mm512_set1_pd(origin_time);
+    const __m512d vvel = _mm512_set1_pd(velocity);
+    __m512d acc[9];
+    for (auto& a : acc) {
+        a = zero;
+    }
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d dx = _mm512_sub_pd(vcx, _mm512_loadu_pd(lat + i));
+        __m512d dy = _mm512_sub_pd(vcy, _mm512_loadu_pd(lon + i));
+        __m512d dist = _mm512_sqrt_pd(_mm512_fmadd_pd(dx, dx, _mm512_mul_pd(dy, dy)));
+        __m512d r = _mm512_sub_pd(_mm512_sub_pd(_mm512_loadu_pd(time + i), vt0), _mm512_div_pd(dist, vvel));
+        __m512d scale = _mm512_maskz_div_pd(_mm512_cmp_pd_mask(dist, zero, _CMP_GT_OQ),
+                                            one, _mm512_mul_pd(dist, vvel));
+        __m512d gx = _mm512_mul_pd(dx, scale);
+        __m512d gy = _mm512_mul_pd(dy, scale);
+        acc[0] = _mm512_fmadd_pd(gx, gx, acc[0]);
+        acc[1] = _mm512_fmadd_pd(gx, gy, acc[1]);
+        acc[2] = _mm512_add_pd(acc[2], gx);
+        acc[3] = _mm512_fmadd_pd(gy, gy, acc[3]);
+        acc[4] = _mm512_add_pd(acc[4], gy);
+        acc[5] = _mm512_fmadd_pd(gx, r, acc[5]);
+        acc[6] = _mm512_fmadd_pd(gy, r, acc[6]);
+        acc[7] = _mm512_add_pd(acc[7], r);
+        acc[8] = _mm512_fmadd_pd(r, r, acc[8]);
+    }
+    normalEquationsScalar(lat + i, lon + i, time + i, n - i, center_lat, center_lon,
+                          origin_time, velocity, sums);
+    for (int k = 0; k < 9; k++) {
+        sums[k] += _mm512_reduce_add_pd(acc[k]);
+    }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+static const TriangulationKernels AVX2_KERNELS = {
+    "avx2", minTimeAvx2, weightedCentroidAvx2, residualErrorAvx2, residualErrorTableAvx2,
+    normalEquationsAvx2, 3
+};
+
+static const TriangulationKernels AVX512_KERNELS = {
+    "avx512", minTimeAvx512, weightedCentroidAvx512, residualErrorAvx512, residualErrorTableAvx512,
+    normalEquationsAvx512, 7
+};
+
+#endif // EQ_X86_DISPATCH
+
+#if EQ_NEON
+
+static double minTimeNeon(const double* time, size_t n) {
+    size_t i = 0;
+    double min_time = time[0];
+    if (n >= 2) {
+        float64x2_t vmin = vld1q_f64(time);
+        for (i = 2; i + 2 <= n; i += 2) {
+            vmin = vminq_f64(vmin, vld1q_f64(time + i));
+        }
+        min_time = vminvq_f64(vmin);
+    }
+    for (; i < n; i++) {
+        min_time = min(min_time, time[i]);
+    }
+    return min_time;
+}
+
+static void weightedCentroidNeon(const double* lat, const double* lon, const double* time,
+                                 size_t n, double min_time, double* sums) {
+    const float64x2_t one = vdupq_n_f64(1.0);
+    const float64x2_t vmin = vdupq_n_f64(min_time);
+    float64x2_t sx = vdupq_n_f64(0), sy = vdupq_n_f64(0), sw = vdupq_n_f64(0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t dt = vsubq_f64(vld1q_f64(time + i), vmin);
+        float64x2_t w = vdivq_f64(one, vfmaq_f64(one, dt, dt));
+        sx = vfmaq_f64(sx, vld1q_f64(lat + i), w);
+        sy = vfmaq_f64(sy, vld1q_f64(lon + i), w);
+        sw = vaddq_f64(sw, w);
+    }
+    double tail[3];
+    weightedCentroidScalar(lat + i, lon + i, time + i, n - i, min_time, tail);
+    sums[0] = vaddvq_f64(sx) + tail[0];
+    sums[1] = vaddvq_f64(sy) + tail[1];
+    sums[2] = vaddvq_f64(sw) + tail[2];
+}
+
+static double residualErrorNeon(const double* lat, const double* lon, const double* time,
+                                size_t n, double center_lat, double center_lon,
+                                double min_time, double velocity) {
+    const float64x2_t vcx = vdupq_n_f64(center_lat);
+    const float64x2_t vcy = vdupq_n_f64(center_lon);
+    const float64x2_t vmin = vdupq_n_f64(min_time);
+    const float64x2_t vvel = vdupq_n_f64(velocity);
+    float64x2_t err = vdupq_n_f64(0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t dx = vsubq_f64(vcx, vld1q_f64(lat + i));
+        float64x2_t dy = vsubq_f64(vcy, vld1q_f64(lon + i));
+        float64x2_t dist = vsqrtq_f64(vfmaq_f64(vmulq_f64(dy, dy), dx, dx));
+        float64x2_t actual = vsubq_f64(vld1q_f64(time + i), vmin);
+        float64x2_t diff = vsubq_f64(vdivq_f64(dist, vvel), actual);
+        err = vfmaq_f64(err, diff, diff);
+    }
+    return vaddvq_f64(err) + residualErrorScalar(lat + i, lon + i, time + i, n - i,
+                                                 center_lat, center_lon, min_time, velocity);
+}
+
+static void normalEquationsNeon(const double* lat, const double* lon, const double* time,
+                                size_t n, double center_lat, double center_lon,
+                                double origin_time, double velocity, double* sums) {
+    const float64x2_t zero = vdupq_n_f64(0);
+    const float64x2_t one = vdupq_n_f64(1.0);
+    const float64x2_t vcx = vdupq_n_f64(center_lat);
+    const float64x2_t vcy = vdupq_n_f64(center_lon);
+    const float64x2_t vt0 = vdupq_n_f64(origin_time);
+    const float64x2_t vvel = vdupq_n_f64(velocity);
+    float64x2_t acc[9];
+    for (auto& a : acc) {
+        a = zero;
+    }
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t dx = vsubq_f64(vcx, vld1q_f64(lat + i));
+        float64x2_t dy = vsubq_f64(vcy, vld1q_f64(lon + i));
+        float64x2_t dist = vsqrtq_f64(vfmaq_f64(vmulq_f64(dy, dy), dx, dx));
+        float64x2_t r = vsubq_f64(vsubq_f64(vld1q_f64(time + i), vt0), vdivq_f64(dist, vvel));
+        float64x2_t scale = vbslq_f64(vcgtq_f64(dist, zero), vdivq_f64(one, vmulq_f64(dist, vvel)), zero);
+        float64x2_t gx = vmulq_f64(dx, scale);
+        float64x2_t gy = vmulq_f64(dy, scale);
+        acc[0] = vfmaq_f64(acc[0], gx, gx);
+        acc[1] = vfmaq_f64(acc[1], gx, gy);
+        acc[2] = vaddq_f64(acc[2], gx);
+        acc[3] = vfmaq_f64(acc[3], gy, gy);
+        acc[4] = vaddq_f64(acc[4], gy);
+        acc[5] = vfmaq_f64(acc[5], gx, r);
+        acc[6] = vfmaq_f64(acc[6], gy, r);
+        acc[7] = vaddq_f64(acc[7], r);
+        acc[8] = vfmaq_f64(acc[8], r, r);
+    }
+    normalEquationsScalar(lat + i, lon + i, time + i, n - i, center_lat, center_lon,
+                          origin_time, velocity, sums);
+    for (int k = 0; k < 9; k++) {
+        sums[k] += vaddvq_f64(acc[k]);
+    }
+}
+
+static const TriangulationKernels NEON_KERNELS = {
+    "neon", minTimeNeon, weightedCentroidNeon, residualErrorNeon,
+    residualErrorTableScalar,  // NEON has no gather
+    normalEquationsNeon,
+    3                          // Not measured; taken from the AVX2 set
+};
+
+#endif // EQ_NEON
+
+// Kernel sets usable on this CPU, widest first; scalar is always last
+const vector<const TriangulationKernels*>& TriangulationKernels::available() {
+    static const vector<const TriangulationKernels*> kernels = [] {
+        vector<const TriangulationKernels*> supported;
+#if EQ_X86_DISPATCH
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            supported.push_back(&AVX512_KERNELS);
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            supported.push_back(&AVX2_KERNELS);
+        }
+#endif
+#if EQ_NEON
+        supported.push_back(&NEON_KERNELS);
+#endif
+        supported.push_back(&SCALAR_KERNELS);
+        return supported;
+    }();
+    return kernels;
+}
+
+const TriangulationKernels& TriangulationKernels::best() {
+    return *available().front();
+}
+
+const TriangulationKernels* TriangulationKernels::find(const string& name) {
+    for (const TriangulationKernels* kernels : available()) {
+        if (name == kernels->name) {
+            return kernels;
+        }
+    }
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Float32 leaf kernels for FloatStationSet. The per-station arithmetic runs in
+// float at twice the lanes of the double sets; every reduction is widened to
+// double before it is accumulated, so long leaves do not lose precision.
+// Sets are matched to the double sets by name.
+// ---------------------------------------------------------------------------
+
+struct FloatTriangulationKernels {
+    const char* name;
+    double (*minTime)(const float* time, size_t n);
+    void (*weightedCentroid)(const float* lat, const float* lon, const float* time,
+                             size_t n, double min_time, double* sums);
+    double (*residualError)(const float* lat, const float* lon, const float* time,
+                            size_t n, double center_lat, double center_lon,
+                            double min_time, double velocity);
+    
+    static const vector<const FloatTriangulationKernels*>& available();
+    // The float set of the same instruction set, or the scalar one
+    static const FloatTriangulationKernels& matching(const TriangulationKernels& kernels);
+};
+
+static double minTimeFloatScalar(const float* time, size_t n) {
+    float min_time = time[0];
+    for (size_t i = 0; i < n; i++) {
+        min_time = min(min_time, time[i]);
+    }
+    return min_time;
+}
+
+static void weightedCentroidFloatScalar(const float* lat, const float* lon, const float* time,
+                                        size_t n, double min_time, double* sums) {
+    float min_f = static_cast<float>(min_time);
+    double sum_x = 0, sum_y = 0, total_weight = 0;
+    for (size_t i = 0; i < n; i++) {
+        float time_diff = time[i] - min_f;
+        float weight = 1.0f / (1.0f + time_diff * time_diff);
+        sum_x += lat[i] * weight;
+        sum_y += lon[i] * weight;
+        total_weight += weight;
+    }
+    sums[0] = sum_x;
+    sums[1] = sum_y;
+    sums[2] = total_weight;
+}
+
+static double residualErrorFloatScalar(const float* lat, const float* lon, const float* time,
+                                       size_t n, double center_lat, double center_lon,
+                                       double min_time, double velocity) {
+    float cx = static_cast<float>(center_lat), cy = static_cast<float>(center_lon);
+    float min_f = static_cast<float>(min_time), velocity_f = static_cast<float>(velocity);
+    double error = 0;
+    for (size_t i = 0; i < n; i++) {
+        float dx = cx - lat[i];
+        float dy = cy - lon[i];
+        float diff = sqrt(dx * dx + dy * dy) / velocity_f - (time[i] - min_f);
+        error += diff * diff;
+    }
+    return error;
+}
+
+static const FloatTriangulationKernels SCALAR_FLOAT_KERNELS = {
+    "scalar", minTimeFloatScalar, weightedCentroidFloatScalar, residualErrorFloatScalar
+};
+
+#if EQ_X86_DISPATCH
+
+// Widens both halves of v to double and adds them to acc
+__attribute__((target("avx2,fma")))
+static __m256d accumulateWidenedAvx2(__m256d acc, __m256 v) {
+    acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+    return _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+}
+
+__attribute__((target("avx2,fma")))
+static double minTimeFloatAvx2(const float* time, size_t n) {
+    size_t i = 0;
+    float min_time = time[0];
+    if (n >= 8) {
+        __m256 vmin = _mm256_loadu_ps(time);
+        for (i = 8; i + 8 <= n; i += 8) {
+            vmin = _mm256_min_ps(vmin, _mm256_loadu_ps(time + i));
+        }
+        __m128 m = _mm_min_ps(_mm256_castps256_ps128(vmin), _mm256_extractf128_ps(vmin, 1));
+        m = _mm_min_ps(m, _mm_movehl_ps(m, m));
+        min_time = _mm_cvtss_f32(_mm_min_ss(m, _mm_shuffle_ps(m, m, 1)));
+    }
+    for (; i < n; i++) {
+        min_time = min(min_time, time[i]);
+    }
+    return min_time;
+}
+
+__attribute__((target("avx2,fma")))
+static void weightedCentroidFloatAvx2(const float* lat, const float* lon, const float* time,
+                                      size_t n, double min_time, double* sums) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 vmin = _mm256_set1_ps(static_cast<float>(min_time));
+    __m256d sx = _mm256_setzero_pd(), sy = _mm256_setzero_pd(), sw = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 dt = _mm256_sub_ps(_mm256_loadu_ps(time + i), vmin);
+        __m256 w = _mm256_div_ps(one, _mm256_fmadd_ps(dt, dt, one));
+        sx = accumulateWidenedAvx2(sx, _mm256_mul_ps(_mm256_loadu_ps(lat + i), w));
+        sy = accumulateWidenedAvx2(sy, _mm256_mul_ps(_mm256_loadu_ps(lon + i), w));
+        sw = accumulateWidenedAvx2(sw, w);
+    }
+    double tail[3];
+    weightedCentroidFloatScalar(lat + i, lon + i, time + i, n - i, min_time, tail);
+    sums[0] = horizontalSumAvx2(sx) + tail[0];
+    sums[1] = horizontalSumAvx2(sy) + tail[1];
+    sums[2] = horizontalSumAvx2(sw) + tail[2];
+}
+
+__attribute__((target("avx2,fma")))
+static double residualErrorFloatAvx2(const float* lat, const float* lon, const float* time,
+                                     size_t n, double center_lat, double center_lon,
+                                     double min_time, double velocity) {
+    const __m256 vcx = _mm256_set1_ps(static_cast<float>(center_lat));
+    const __m256 vcy = _mm256_set1_ps(static_cast<float>(center_lon));
+    const __m256 vmin = _mm256_set1_ps(static_cast<float>(min_time));
+    const __m256 vvel = _mm256_set1_ps(static_cast<float>(velocity));
+    __m256d err = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 dx = _mm256_sub_ps(vcx, _mm256_loadu_ps(lat + i));
+        __m256 dy = _mm256_sub_ps(vcy, _mm256_loadu_ps(lon + i));
+        __m256 dist = _mm256_sqrt_ps(_mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy)));
+        __m256 actual = _mm256_sub_ps(_mm256_loadu_ps(time + i), vmin);
+        __m256 diff = _mm256_sub_ps(_mm256_div_ps(dist, vvel), actual);
+        err = accumulateWidenedAvx2(err, _mm256_mul_ps(diff, diff));
+    }
+    return horizontalSumAvx2(err) + residualErrorFloatScalar(lat + i, lon + i, time + i, n - i,
+                                                             center_lat, center_lon, min_time, velocity);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+__attribute__((target("avx512f")))
+static __m512d accumulateWidenedAvx512(__m512d acc, __m512 v) {
+    acc = _mm512_add_pd(acc, _mm512_cvtps_pd(_mm512_castps512_ps256(v)));
+    __m256 high = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1));
+    return _mm512_add_pd(acc, _mm512_cvtps_pd(high));
+}
+
+__attribute__((target("avx512f")))
+static double minTimeFloatAvx512(const float* time, size_t n) {
+    size_t i = 0;
+    float min_time = time[0];
+    if (n >= 16) {
+        __m512 vmin = _mm512_loadu_ps(time);
+        for (i = 16; i + 16 <= n; i += 16) {
+            vmin = _mm512_min_ps(vmin, _mm512_loadu_ps(time + i));
+        }
+        min_time = _mm512_reduce_min_ps(vmin);
+    }
+    for (; i < n; i++) {
+        min_time = min(min_time, time[i]);
+    }
+    return min_time;
+}
+
+__attribute__((target("avx512f")))
+static void weightedCentroidFloatAvx512(const float* lat, const float* lon, const float* time,
+                                        size_t n, double min_time, double* sums) {
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 vmin = _mm512_set1_ps(static_cast<float>(min_time));
+    __m512d sx = _mm512_setzero_pd(), sy = _mm512_setzero_pd(), sw = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 dt = _mm512_sub_ps(_mm512_loadu_ps(time + i), vmin);
+        __m512 w = _mm512_div_ps(one, _mm512_fmadd_ps(dt, dt, one));
+        sx = accumulateWidenedAvx512(sx, _mm512_mul_ps(_mm512_loadu_ps(lat + i), w));
+        sy = accumulateWidenedAvx512(sy, _mm512_mul_ps(_mm512_loadu_ps(lon + i), w));
+        sw = accumulateWidenedAvx512(sw, w);
+    }
+    double tail[3];
+    weightedCentroidFloatScalar(lat + i, lon + i, time + i, n - i, min_time, tail);
+    sums[0] = _mm512_reduce_add_pd(sx) + tail[0];
+    sums[1] = _mm512_reduce_add_pd(sy) + tail[1];
+    sums[2] = _mm512_reduce_add_pd(sw) + tail[2];
+}
+
+__attribute__((target("avx512f")))
+static double residualErrorFloatAvx512(const float* lat, const float* lon, const float* time,
+                                       size_t n, double center_lat, double center_lon,
+                                       double min_time, double velocity) {
+    const __m512 vcx = _mm512_set1_ps(static_cast<float>(center_lat));
+    const __m512 vcy = _mm512_set1_ps(static_cast<float>(center_lon));
+    const __m512 vmin = _mm512_set1_ps(static_cast<float>(min_time));
+    const __m512 vvel = _mm512_set1_ps(static_cast<float>(velocity));
+    __m512d err = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 dx = _mm512_sub_ps(vcx, _mm512_loadu_ps(lat + i));
+        __m512 dy = _mm512_sub_ps(vcy, _mm512_loadu_ps(lon + i));
+        __m512 dist = _mm512_sqrt_ps(_mm512_fmadd_ps(dx, dx, _mm512_mul_ps(dy, dy)));
+        __m512 actual = _mm512_sub_ps(_mm512_loadu_ps(time + i), vmin);
+        __m512 diff = _mm512_sub_ps(_mm512_div_ps(dist, vvel), actual);
+        err = accumulateWidenedAvx512(err, _mm512_mul_ps(diff, diff));
+    }
+    return _mm512_reduce_add_pd(err) + residualErrorFloatScalar(lat + i, lon + i, time + i, n - i,
+                                                                center_lat, center_lon, min_time, velocity);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+static const FloatTriangulationKernels AVX2_FLOAT_KERNELS = {
+    "avx2", minTimeFloatAvx2, weightedCentroidFloatAvx2, residualErrorFloatAvx2
+};
+
+static const FloatTriangulationKernels AVX512_FLOAT_KERNELS = {
+    "avx512", minTimeFloatAvx512, weightedCentroidFloatAvx512, residualErrorFloatAvx512
+};
+
+#endif // EQ_X86_DISPATCH
+
+#if EQ_NEON
+
+static float64x2_t accumulateWidenedNeon(float64x2_t acc, float32x4_t v) {
+    acc = vaddq_f64(acc, vcvt_f64_f32(vget_low_f32(v)));
+    return vaddq_f64(acc, vcvt_high_f64_f32(v));
+}
+
+static double minTimeFloatNeon(const float* time, size_t n) {
+    size_t i = 0;
+    float min_time = time[0];
+    if (n >= 4) {
+        float32x4_t vmin = vld1q_f32(time);
+        for (i = 4; i + 4 <= n; i += 4) {
+            vmin = vminq_f32(vmin, vld1q_f32(time + i));
+        }
+        min_time = vminvq_f32(vmin);
+    }
+    for (; i < n; i++) {
+        min_time = min(min_time, time[i]);
+    }
+    return min_time;
+}
+
+static void weightedCentroidFloatNeon(const float* lat, const float* lon, const float* time,
+                                      size_t n, double min_time, double* sums) {
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t vmin = vdupq_n_f32(static_cast<float>(min_time));
+    float64x2_t sx = vdupq_n_f64(0), sy = vdupq_n_f64(0), sw = vdupq_n_f64(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t dt = vsubq_f32(vld1q_f32(time + i), vmin);
+        float32x4_t w = vdivq_f32(one, vfmaq_f32(one, dt, dt));
+        sx = accumulateWidenedNeon(sx, vmulq_f32(vld1q_f32(lat + i), w));
+        sy = accumulateWidenedNeon(sy, vmulq_f32(vld1q_f32(lon + i), w));
+        sw = accumulateWidenedNeon(sw, w);
+    }
+    double tail[3];
+    weightedCentroidFloatScalar(lat + i, lon + i, time + i, n - i, min_time, tail);
+    sums[0] = vaddvq_f64(sx) + tail[0];
+    sums[1] = vaddvq_f64(sy) + tail[1];
+    sums[2] = vaddvq_f64(sw) + tail[2];
+}
+
+static double residualErrorFloatNeon(const float* lat, const float* lon, const float* time,
+                                     size_t n, double center_lat, double center_lon,
+                                     double min_time, double velocity) {
+    const float32x4_t vcx = vdupq_n_f32(static_cast<float>(center_lat));
+    const float32x4_t vcy = vdupq_n_f32(static_cast<float>(center_lon));
+    const float32x4_t vmin = vdupq_n_f32(static_cast<float>(min_time));
+    const float32x4_t vvel = vdupq_n_f32(static_cast<float>(velocity));
+    float64x2_t err = vdupq_n_f64(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t dx = vsubq_f32(vcx, vld1q_f32(lat + i));
+        float32x4_t dy = vsubq_f32(vcy, vld1q_f32(lon + i));
+        float32x4_t dist = vsqrtq_f32(vfmaq_f32(vmulq_f32(dy, dy), dx, dx));
+        float32x4_t actual = vsubq_f32(vld1q_f32(time + i), vmin);
+        float32x4_t diff = vsubq_f32(vdivq_f32(dist, vvel), actual);
+        err = accumulateWidenedNeon(err, vmulq_f32(diff, diff));
+    }
+    return vaddvq_f64(err) + residualErrorFloatScalar(lat + i, lon + i, time + i, n - i,
+                                                      center_lat, center_lon, min_time, velocity);
+}
+
+static const FloatTriangulationKernels NEON_FLOAT_KERNELS = {
+    "neon", minTimeFloatNeon, weightedCentroidFloatNeon, residualErrorFloatNeon
+};
+
+#endif // EQ_NEON
+
+const vector<const FloatTriangulationKernels*>& FloatTriangulationKernels::available() {
+    static const vector<const FloatTriangulationKernels*> kernels = [] {
+        vector<const FloatTriangulationKernels*> supported;
+        for (const TriangulationKernels* k : TriangulationKernels::available()) {
+#if EQ_X86_DISPATCH
+            if (k == &AVX512_KERNELS) {
+                supported.push_back(&AVX512_FLOAT_KERNELS);
+            } else if (k == &AVX2_KERNELS) {
+                supported.push_back(&AVX2_FLOAT_KERNELS);
+            }
+#endif
+#if EQ_NEON
+            if (k == &NEON_KERNELS) {
+                supported.push_back(&NEON_FLOAT_KERNELS);
+            }
+#endif
+            (void)k;
+        }
+        supported.push_back(&SCALAR_FLOAT_KERNELS);
+        return supported;
+    }();
+    return kernels;
+}
+
+const FloatTriangulationKernels& FloatTriangulationKernels::matching(const TriangulationKernels& kernels) {
+    for (const FloatTriangulationKernels* k : available()) {
+        if (strcmp(k->name, kernels.name) == 0) {
+            return *k;
+        }
+    }
+    return SCALAR_FLOAT_KERNELS;
+}
+
+// ---------------------------------------------------------------------------
+// Leaf solvers specialised on the station count. The loops have a
+// compile-time trip count and are fully unrolled; the arithmetic follows the
+// scalar kernels in the same order, so results are identical to them.
+// Leaves of 1..MAX_FIXED_LEAF stations dispatch through FIXED_LEAF_SOLVERS.
+//
+// Which is faster depends on the set in use. BM_LeafTriangulation, ns per
+// 1024 leaves on a Xeon with AVX-512 (fixed / generic):
+//
+//   stations   scalar          avx2            avx512
+//   2-3        15-24k / 19-33k 15-23k / 22-32k 15-25k / 28-36k
+//   4          26k / 30k       24k / 22k       26k / 43k
+//   5-7        38-51k / 39-54k 39-56k / 33-58k 40-52k / 51-69k
+//   8          56k / 53k       56k / 33k       57k / 35k
+//   16         93k / 87k       97k / 52k       93k / 54k
+//
+// The masked tail makes AVX-512 slow on short leaves, so each set records
+// in fixed_leaf_limit the sizes the fixed solvers should take over.
+// ---------------------------------------------------------------------------
+
+static const size_t MAX_FIXED_LEAF = 16;
+
+typedef EpicenterResult (*FixedLeafSolver)(const double* lat, const double* lon, const double* time,
+                                           double min_time, double velocity);
+
+template <size_t N>
+static EpicenterResult triangulateFixed(const double* lat, const double* lon, const double* time,
+                                        double min_time, double velocity) {
+    static_assert(N >= 1 && N <= MAX_FIXED_LEAF, "no fixed solver for this leaf size");
+    if constexpr (N == 1) {
+        return EpicenterResult(Point(lat[0], lon[0]), 1.0, 0);
+    }
+    
+    double weight[N];
+    #pragma GCC unroll 16
+    for (size_t i = 0; i < N; i++) {
+        double time_diff = time[i] - min_time;
+        weight[i] = 1.0 / (1.0 + time_diff * time_diff);
+    }
+    double sum_x = 0, sum_y = 0, total_weight = 0;
+    #pragma GCC unroll 16
+    for (size_t i = 0; i < N; i++) {
+        sum_x += lat[i] * weight[i];
+        sum_y += lon[i] * weight[i];
+        total_weight += weight[i];
+    }
+    
+    // Residuals are independent and vectorize; only the sums stay in order
+    Point center(sum_x / total_weight, sum_y / total_weight);
+    double residual[N];
+    #pragma GCC unroll 16
+    for (size_t i = 0; i < N; i++) {
+        double dx = center.x - lat[i];
+        double dy = center.y - lon[i];
+        residual[i] = sqrt(dx * dx + dy * dy) / velocity - (time[i] - min_time);
+    }
+    double error = 0;
+    #pragma GCC unroll 16
+    for (size_t i = 0; i < N; i++) {
+        error += residual[i] * residual[i];
+    }
+    
+    double confidence = 1.0 / (1.0 + error / N);
+    return EpicenterResult(center, confidence, error);
+}
+
+// Indexed by station count; entry 0 is unused
+static const FixedLeafSolver FIXED_LEAF_SOLVERS[MAX_FIXED_LEAF + 1] = {
+    nullptr,
+    triangulateFixed<1>,  triangulateFixed<2>,  triangulateFixed<3>,  triangulateFixed<4>,
+    triangulateFixed<5>,  triangulateFixed<6>,  triangulateFixed<7>,  triangulateFixed<8>,
+    triangulateFixed<9>,  triangulateFixed<10>, triangulateFixed<11>, triangulateFixed<12>,
+    triangulateFixed<13>, triangulateFixed<14>, triangulateFixed<15>, triangulateFixed<16>
+};
+
+// Fixed-size thread pool with one task deque per worker. A worker pushes and
+// pops its own deque at the back (newest first, still cache-warm) and steals
+// from the front of the others when it runs dry.
+class WorkStealingPool {
+private:
+    struct WorkerQueue {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+    
+    vector<unique_ptr<WorkerQueue>> queues;
+    vector<thread> threads;
+    atomic<size_t> pending;          // Tasks queued but not yet started
+    atomic<size_t> next_queue;       // Round-robin target for outside submits
+    atomic<bool> stopping;
+    mutex sleep_lock;
+    condition_variable wake;
+    
+    static thread_local WorkStealingPool* current_pool;
+    static thread_local size_t current_index;
+    
+public:
+    // num_threads = 0 uses one worker per hardware thread
+    explicit WorkStealingPool(size_t num_threads = 0) 
+        : pending(0), next_queue(0), stopping(false) {
+        if (num_threads == 0) {
+            num_threads = max(1u, thread::hardware_concurrency());
+        }
+        for (size_t i = 0; i < num_threads; i++) {
+            queues.push_back(unique_ptr<WorkerQueue>(new WorkerQueue()));
+        }
+        for (size_t i = 0; i < num_threads; i++) {
+            threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+        }
+    }
+    
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> guard(sleep_lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : threads) {
+            worker.join();
+        }
+    }
+    
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    
+    size_t size() const { return threads.size(); }
+    
+    void submit(function<void()> task) {
+        size_t index = (current_pool == this) ? current_index : next_queue++ % queues.size();
+        // Counted before it is visible, so a thief's decrement cannot
+        // run first and wrap the counter
+        pending++;
+        {
+            lock_guard<mutex> guard(queues[index]->lock);
+            queues[index]->tasks.push_back(move(task));
+        }
+        {
+            // Pairs with the predicate check in workerLoop so a worker that
+            // is about to sleep cannot miss this task
+            lock_guard<mutex> guard(sleep_lock);
+        }
+        wake.notify_one();
+    }
+    
+    // Runs one queued task on the calling thread, if there is one. Threads
+    // waiting on a TaskGroup call this so they help instead of blocking.
+    bool runPendingTask() {
+        function<void()> task;
+        if (!popTask(task)) {
+            return false;
+        }
+        task();
+        return true;
+    }
+    
+private:
+    bool popTask(function<void()>& task) {
+        size_t n = queues.size();
+        bool is_worker = (current_pool == this);
+        size_t home = is_worker ? current_index : 0;
+        
+        if (is_worker) {
+            WorkerQueue& own = *queues[home];
+            lock_guard<mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                task = move(own.tasks.back());
+                own.tasks.pop_back();
+                pending--;
+                return true;
+            }
+        }
+        
+        for (size_t k = 0; k < n; k++) {
+            size_t victim = (home + 1 + k) % n;
+            if (is_worker && victim == home) {
+                continue;
+            }
+            WorkerQueue& other = *queues[victim];
+            lock_guard<mutex> guard(other.lock);
+            if (!other.tasks.empty()) {
+                task = move(other.tasks.front());
+                other.tasks.pop_front();
+                pending--;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void workerLoop(size_t index) {
+        current_pool = this;
+        current_index = index;
+        while (true) {
+            if (runPendingTask()) {
+                continue;
+            }
+            unique_lock<mutex> guard(sleep_lock);
+            wake.wait(guard, [this] { return stopping || pending > 0; });
+            if (stopping && pending == 0) {
+                return;
+            }
+        }
+    }
+};
+
+thread_local WorkStealingPool* WorkStealingPool::current_pool = nullptr;
+thread_local size_t WorkStealingPool::current_index = 0;
+
+// Group of tasks on a pool that can be waited for together. An exception
+// from a task stays with the group: the other tasks still run, and wait()
+// rethrows the first failure once all of them have finished.
+class TaskGroup {
+private:
+    WorkStealingPool& pool;
+    atomic<size_t> outstanding;
+    mutex failure_lock;
+    exception_ptr failure;
+    
+public:
+    explicit TaskGroup(WorkStealingPool& _pool) : pool(_pool), outstanding(0) {}
+    
+    // Waits without rethrowing; call wait() to see a task's exception
+    ~TaskGroup() { drain(); }
+    
+    void run(function<void()> task) {
+        outstanding++;
+        pool.submit([this, task] {
+            try {
+                task();
+            } catch (...) {
+                lock_guard<mutex> guard(failure_lock);
+                if (!failure) {
+                    failure = current_exception();
+                }
+            }
+            outstanding--;
+        });
+    }
+    
+    void wait() {
+        drain();
+        if (failure) {
+            exception_ptr first = failure;
+            failure = nullptr;
+            rethrow_exception(first);
+        }
+    }
+    
+private:
+    void drain() {
+        while (outstanding > 0) {
+            if (!pool.runPendingTask()) {
+                this_thread::yield();
+            }
+        }
+    }
+};
+
+// Bounded lock-free multi-producer multi-consumer queue (Vyukov). Each cell
+// carries a sequence number that tells producers and consumers whose turn
+// it is, so a push or pop is one CAS on the shared position plus one store.
+template <typename T>
+class MpmcQueue {
+private:
+    struct Cell {
+        atomic<size_t> sequence;
+        T value;
+    };
+    
+    unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) atomic<size_t> enqueue_pos;
+    alignas(64) atomic<size_t> dequeue_pos;
+    
+public:
+    // capacity is rounded up to a power of two
+    explicit MpmcQueue(size_t capacity) : enqueue_pos(0), dequeue_pos(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+    
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+    
+    size_t capacity() const { return mask + 1; }
+    
+    // Moves value in; returns false without touching it if the queue is full
+    bool tryPush(T& value) {
+        size_t pos = enqueue_pos.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(memory_order_relaxed);
+            }
+        }
+    }
+    
+    bool tryPop(T& value) {
+        size_t pos = dequeue_pos.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + mask + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos.load(memory_order_relaxed);
+            }
+        }
+    }
+    
+    // Approximate while other threads are pushing or popping
+    size_t sizeApprox() const {
+        size_t tail = enqueue_pos.load(memory_order_relaxed);
+        size_t head = dequeue_pos.load(memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+};
+
+// Bounded lock-free single-producer single-consumer ring. Each side caches
+// the other's index and only reloads it when the ring looks full or empty.
+template <typename T>
+class SpscRing {
+private:
+    unique_ptr<T[]> slots;
+    size_t mask;
+    alignas(64) atomic<size_t> head;     // Next slot to read (consumer)
+    size_t cached_tail;
+    alignas(64) atomic<size_t> tail;     // Next slot to write (producer)
+    size_t cached_head;
+    
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity) : head(0), cached_tail(0), tail(0), cached_head(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        slots.reset(new T[size]);
+        mask = size - 1;
+    }
+    
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+    
+    // Producer side
+    bool tryPush(const T& value) {
+        size_t t = tail.load(memory_order_relaxed);
+        if (t - cached_head > mask) {
+            cached_head = head.load(memory_order_acquire);
+            if (t - cached_head > mask) {
+                return false;
+            }
+        }
+        slots[t & mask] = value;
+        tail.store(t + 1, memory_order_release);
+        return true;
+    }
+    
+    // Consumer side
+    bool tryPop(T& value) {
+        size_t h = head.load(memory_order_relaxed);
+        if (h == cached_tail) {
+            cached_tail = tail.load(memory_order_acquire);
+            if (h == cached_tail) {
+                return false;
+            }
+        }
+        value = slots[h & mask];
+        head.store(h + 1, memory_order_release);
+        return true;
+    }
+};
+
+// Whether quadrant subproblems may run concurrently
+enum class ExecPolicy {
+    serial,
+    parallel    // Spawn quadrants onto a work-stealing pool above the cutoff
+};
+
+// Memory resource that forwards to another one and counts what passes through
+class CountingResource : public pmr::memory_resource {
+private:
+    pmr::memory_resource* upstream;
+    atomic<size_t> bytes;                // Atomic so parallel subtrees may share it
+    atomic<size_t> allocations;
+    
+public:
+    explicit CountingResource(pmr::memory_resource* _upstream = pmr::new_delete_resource())
+        : upstream(_upstream), bytes(0), allocations(0) {}
+    
+    size_t bytesAllocated() const { return bytes; }
+    size_t allocationCount() const { return allocations; }
+    
+private:
+    void* do_allocate(size_t size, size_t alignment) override {
+        bytes.fetch_add(size, memory_order_relaxed);
+        allocations.fetch_add(1, memory_order_relaxed);
+        return upstream->allocate(size, alignment);
+    }
+    
+    void do_deallocate(void* p, size_t size, size_t alignment) override {
+        upstream->deallocate(p, size, alignment);
+    }
+    
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Monotonic arena for recursion-scoped temporaries, released in one shot
+// when it goes out of scope. Each thread keeps one reusable block: an arena
+// starts in it and only goes to the heap once the block is used up, and the
+// block then grows to that high-water mark, so a steady workload stops
+// calling malloc. An arena opened while another is live on the same thread
+// (a task run by a thread waiting on its TaskGroup) starts on the heap.
+class ScratchArena {
+private:
+    struct ThreadBlock {
+        vector<unsigned char> storage;
+        bool in_use;
+        
+        ThreadBlock() : in_use(false) {}
+    };
+    
+    static ThreadBlock& threadBlock() {
+        static thread_local ThreadBlock block;
+        return block;
+    }
+    
+    ThreadBlock* block;                    // nullptr when not using the block
+    CountingResource overflow;             // Heap requests past the block
+    optional<pmr::monotonic_buffer_resource> arena;
+    
+public:
+    explicit ScratchArena(size_t initial_bytes = 64 * 1024) : block(nullptr) {
+        ThreadBlock& local = threadBlock();
+        if (!local.in_use) {
+            block = &local;
+            block->in_use = true;
+            if (block->storage.size() < initial_bytes) {
+                block->storage.resize(initial_bytes);
+            }
+            arena.emplace(block->storage.data(), block->storage.size(), &overflow);
+        } else {
+            arena.emplace(initial_bytes, &overflow);
+        }
+    }
+    
+    ~ScratchArena() {
+        arena.reset();
+        if (block) {
+            if (overflow.bytesAllocated() > 0) {
+                block->storage.resize(block->storage.size() + overflow.bytesAllocated());
+            }
+            block->in_use = false;
+        }
+    }
+    
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+    
+    pmr::memory_resource* resource() { return &*arena; }
+    
+    // Bytes this arena had to request from the heap
+    size_t heapBytes() const { return overflow.bytesAllocated(); }
+};
+
+// ---------------------------------------------------------------------------
+// Optional hot-path instrumentation. Build with -DEARTHQUAKE_INSTRUMENTATION
+// to have every locate call fill the locator's LocatorProfile: time per
+// phase, nodes per depth, leaf counts and sizes, and bytes allocated, plus
+// trace spans exportable as Chrome trace JSON (chrome://tracing, Perfetto).
+// Without the macro the hooks expand to nothing.
+// ---------------------------------------------------------------------------
+
+#ifdef EARTHQUAKE_INSTRUMENTATION
+
+class LocatorProfile {
+public:
+    enum Phase { call, setup, partition, leaf, combine, refine, NUM_PHASES };
+    
+    struct Span {
+        Phase phase;
+        int depth;
+        size_t stations;
+        int thread;
+        double start_us;       // Relative to the start of the call
+        double duration_us;
+    };
+    
+    // Spans are kept for nodes up to this depth; counters cover every node
+    int trace_depth = 6;
+    
+    double phase_us[NUM_PHASES] = {};
+    uint64_t internal_nodes = 0;
+    uint64_t leaves = 0;
+    vector<uint64_t> nodes_per_depth;
+    vector<uint64_t> leaf_sizes;       // Histogram: leaf_sizes[k] = leaves of k stations
+    size_t bytes_allocated = 0;        // pmr requests plus growth of reused buffers
+    uint64_t pruned_cells = 0;         // Children cut by LocatorConfig::prune_mode
+    vector<Span> spans;
+    
+    static const char* phaseName(Phase phase) {
+        static const char* names[NUM_PHASES] = {"locate", "setup", "partition", "leaf", "combine", "refine"};
+        return names[phase];
+    }
+    
+    void clear() {
+        lock_guard<mutex> guard(lock);
+        fill(phase_us, phase_us + NUM_PHASES, 0.0);
+        internal_nodes = leaves = 0;
+        nodes_per_depth.clear();
+        leaf_sizes.clear();
+        bytes_allocated = 0;
+        pruned_cells = 0;
+        spans.clear();
+        origin = steady_clock::now();
+    }
+    
+    void record(Phase phase, int depth, size_t stations, steady_clock::time_point start,
+                steady_clock::time_point end) {
+        lock_guard<mutex> guard(lock);
+        double duration_us = duration<double, micro>(end - start).count();
+        phase_us[phase] += duration_us;
+        if (phase == partition || phase == leaf) {
+            if (depth >= static_cast<int>(nodes_per_depth.size())) {
+                nodes_per_depth.resize(depth + 1, 0);
+            }
+            nodes_per_depth[depth]++;
+        }
+        if (phase == partition) {
+            internal_nodes++;
+        } else if (phase == leaf) {
+            leaves++;
+            if (stations >= leaf_sizes.size()) {
+                leaf_sizes.resize(stations + 1, 0);
+            }
+            leaf_sizes[stations]++;
+        }
+        if (depth <= trace_depth) {
+            spans.push_back({phase, depth, stations, threadNumber(),
+                             duration<double, micro>(start - origin).count(), duration_us});
+        }
+    }
+    
+    void addBytes(size_t bytes) {
+        lock_guard<mutex> guard(lock);
+        bytes_allocated += bytes;
+    }
+    
+    void addPruned(size_t cells) {
+        lock_guard<mutex> guard(lock);
+        pruned_cells += cells;
+    }
+    
+    // Trace Event Format: one complete ("X") event per span; the counters go
+    // in otherData
+    void writeChromeTrace(ostream& out) const {
+        out << "{\"traceEvents\":[";
+        for (size_t i = 0; i < spans.size(); i++) {
+            const Span& span = spans[i];
+            out << (i ? ",\n" : "\n") << "{\"name\":\"" << phaseName(span.phase) 
+                << "\",\"cat\":\"locator\",\"ph\":\"X\",\"pid\":1,\"tid\":" << span.thread
+                << ",\"ts\":" << span.start_us << ",\"dur\":" << span.duration_us
+                << ",\"args\":{\"depth\":" << span.depth << ",\"stations\":" << span.stations << "}}";
+        }
+        out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{";
+        for (int p = 0; p < NUM_PHASES; p++) {
+            out << "\"" << phaseName(static_cast<Phase>(p)) << "_us\":" << phase_us[p] << ",";
+        }
+        out << "\"internal_nodes\":" << internal_nodes << ",\"leaves\":" << leaves
+            << ",\"bytes_allocated\":" << bytes_allocated << ",\"pruned_cells\":" << pruned_cells
+            << ",\"nodes_per_depth\":\"" << joined(nodes_per_depth)
+            << "\",\"leaf_sizes\":\"" << joined(leaf_sizes) << "\"}}\n";
+    }
+    
+private:
+    mutable mutex lock;
+    steady_clock::time_point origin = steady_clock::now();
+    
+    // Small stable number per thread for the trace's tid
+    static int threadNumber() {
+        static atomic<int> next_thread(0);
+        thread_local int number = next_thread++;
+        return number;
+    }
+    
+    static string joined(const vector<uint64_t>& values) {
+        string text;
+        for (size_t i = 0; i < values.size(); i++) {
+            text += (i ? " " : "") + to_string(values[i]);
+        }
+        return text;
+    }
+};
+
+// Records the enclosing scope as one span of a phase
+class ProfileScope {
+private:
+    LocatorProfile& profile;
+    LocatorProfile::Phase phase;
+    int depth;
+    size_t stations;
+    steady_clock::time_point start;
+    
+public:
+    ProfileScope(LocatorProfile& _profile, LocatorProfile::Phase _phase, int _depth, size_t _stations)
+        : profile(_profile), phase(_phase), depth(_depth), stations(_stations), 
+          start(steady_clock::now()) {}
+    
+    ~ProfileScope() { profile.record(phase, depth, stations, start, steady_clock::now()); }
+};
+
+#define EQ_PROFILE(statement) statement
+#define EQ_PROFILE_SCOPE(phase, depth, stations) \
+    ProfileScope profile_scope(profile, LocatorProfile::phase, depth, stations)
+
+#else
+
+#define EQ_PROFILE(statement)
+#define EQ_PROFILE_SCOPE(phase, depth, stations)
+
+#endif // EARTHQUAKE_INSTRUMENTATION
+
+// Buffered CSV output. Fields are formatted with to_chars (doubles in their
+// shortest round-trip form) into one buffer, which reaches the stream in a
+// single write whenever it fills, instead of one formatted insertion per
+// field.
+class CsvWriter {
+private:
+    ostream& out;
+    vector<char> buffer;
+    size_t used;
+    bool row_start;
+    
+    static constexpr size_t MAX_FIELD = 32;    // Longest to_chars output plus a separator
+    
+public:
+    explicit CsvWriter(ostream& stream, size_t buffer_bytes = 1 << 20)
+        : out(stream), buffer(max(buffer_bytes, 2 * MAX_FIELD)), used(0), row_start(true) {}
+    
+    ~CsvWriter() { flush(); }
+    
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+    
+    CsvWriter& field(double value) {
+        char* cursor = begin();
+        return end(to_chars(cursor, buffer.data() + buffer.size(), value).ptr);
+    }
+    
+    template <typename T, typename = typename enable_if<is_integral<T>::value>::type>
+    CsvWriter& field(T value) {
+        char* cursor = begin();
+        return end(to_chars(cursor, buffer.data() + buffer.size(), value).ptr);
+    }
+    
+    // Written as is: no quoting, so it must not contain commas or newlines
+    CsvWriter& field(const char* text) {
+        size_t length = strlen(text);
+        if (buffer.size() - used < length + MAX_FIELD) {
+            drain();
+        }
+        if (length + MAX_FIELD > buffer.size()) {
+            buffer.resize(length + MAX_FIELD);
+        }
+        char* cursor = begin();
+        memcpy(cursor, text, length);
+        return end(cursor + length);
+    }
+    
+    void endRow() {
+        if (buffer.size() - used < MAX_FIELD) {
+            drain();
+        }
+        buffer[used++] = '\n';
+        row_start = true;
+    }
+    
+    // Hands the buffered bytes to the stream; false once the stream failed
+    bool flush() {
+        drain();
+        out.flush();
+        return static_cast<bool>(out);
+    }
+    
+private:
+    char* begin() {
+        if (buffer.size() - used < MAX_FIELD) {
+            drain();
+        }
+        if (!row_start) {
+            buffer[used++] = ',';
+        }
+        row_start = false;
+        return buffer.data() + used;
+    }
+    
+    CsvWriter& end(char* cursor) {
+        used = static_cast<size_t>(cursor - buffer.data());
+        return *this;
+    }
+    
+    void drain() {
+        if (used > 0) {
+            out.write(buffer.data(), static_cast<streamsize>(used));
+            used = 0;
+        }
+    }
+};
+
+// How stations are distributed to quadrants at each recursion level
+enum class PartitionMode {
+    copy,       // Copy stations into a new vector per quadrant (reference)
+    in_place,   // Stable-partition one shared SoA buffer and recurse on subranges
+    morton      // Sort the SoA buffer once by Z-order key; a node is the key
+                // range of its prefix, found by binary search
+};
+
+// How a cell is divided into its four children
+enum class SplitStrategy {
+    midpoint,   // Geometric midpoint on both axes (reference)
+    median,     // Median station latitude and median station longitude
+    kd,         // Four slabs at the station quartiles of one axis, alternating with depth
+    balanced    // Median of the wider axis, then each half at its own median of the other
+};
+
+// Storage precision of the in-place workspace
+enum class Precision {
+    float64,    // double columns (reference)
+    float32     // float columns, float leaf arithmetic, double reductions
+};
+
+// How a node joins its children's estimates
+enum class CombineMode {
+    result,     // weightedCombination of the child results, by confidence (reference)
+    summary     // Merge of the children's EpicenterSummary statistics
+};
+
+// What happens to a child cell that branch and bound rules out
+enum class PruneMode {
+    off,        // Recurse into every non-empty child (reference)
+    skip,       // Leave it out of the combine
+    coarse      // Solve it as one leaf instead of recursing
+};
+
+#ifdef EARTHQUAKE_COROUTINES
+// Where a coroutine continues. post() must be thread-safe. An asio loop
+// adapts as a one-line subclass whose post() calls asio::post(io, work).
+class Executor {
+public:
+    virtual ~Executor() {}
+    virtual void post(function<void()> work) = 0;
+};
+
+// Runs work on a WorkStealingPool
+class PoolExecutor : public Executor {
+private:
+    WorkStealingPool& pool;
+    
+public:
+    explicit PoolExecutor(WorkStealingPool& _pool) : pool(_pool) {}
+    
+    void post(function<void()> work) override { pool.submit(std::move(work)); }
+};
+
+// Minimal single-threaded event loop: work waits in a queue until the
+// owning thread calls runPending() or runUntil()
+class LoopExecutor : public Executor {
+private:
+    mutex lock;
+    condition_variable posted;
+    deque<function<void()>> queue;
+    
+public:
+    // Notifies under the lock: the posted work may be what lets the loop
+    // return and destroy this executor
+    void post(function<void()> work) override {
+        lock_guard<mutex> guard(lock);
+        queue.push_back(std::move(work));
+        posted.notify_one();
+    }
+    
+    // Runs what is queued now and returns how many items ran
+    size_t runPending() {
+        deque<function<void()>> ready;
+        {
+            lock_guard<mutex> guard(lock);
+            ready.swap(queue);
+        }
+        for (auto& work : ready) {
+            work();
+        }
+        return ready.size();
+    }
+    
+    // Runs posted work until done() holds, sleeping while the queue is empty
+    template <typename Done>
+    void runUntil(Done done) {
+        while (!done()) {
+            {
+                unique_lock<mutex> guard(lock);
+                posted.wait_for(guard, milliseconds(1), [this] { return !queue.empty(); });
+            }
+            runPending();
+        }
+    }
+};
+
+// Awaitable that resumes the awaiting coroutine through executor.post
+struct ResumeOn {
+    Executor& executor;
+    
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(coroutine_handle<> handle) const {
+        executor.post([handle] { handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+};
+
+inline ResumeOn resumeOn(Executor& executor) { return ResumeOn{executor}; }
+
+// Lazy coroutine result: the body starts when the task is awaited, and on
+// completion it resumes the awaiting coroutine on the thread it finished
+// on. Exceptions from the body are rethrown to the awaiter.
+template <typename T>
+class Task {
+public:
+    struct promise_type {
+        optional<T> value;
+        exception_ptr failure;
+        coroutine_handle<> continuation;
+        
+        Task get_return_object() { return Task(coroutine_handle<promise_type>::from_promise(*this)); }
+        suspend_always initial_suspend() noexcept { return {}; }
+        
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            coroutine_handle<> await_suspend(coroutine_handle<promise_type> handle) const noexcept {
+                coroutine_handle<> next = handle.promise().continuation;
+                return next ? next : noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        
+        void return_value(T result) { value = std::move(result); }
+        void unhandled_exception() { failure = current_exception(); }
+    };
+    
+private:
+    coroutine_handle<promise_type> handle;
+    
+    explicit Task(coroutine_handle<promise_type> _handle) : handle(_handle) {}
+    
+public:
+    Task(Task&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) {
+                handle.destroy();
+            }
+            handle = other.handle;
+            other.handle = nullptr;
+        }
+        return *this;
+    }
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+    
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    
+    bool await_ready() const noexcept { return false; }
+    coroutine_handle<> await_suspend(coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    T await_resume() {
+        if (handle.promise().failure) {
+            rethrow_exception(handle.promise().failure);
+        }
+        return std::move(*handle.promise().value);
+    }
+};
+
+// Fire-and-forget coroutine: runs eagerly and frees itself at the end
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        suspend_never initial_suspend() noexcept { return {}; }
+        suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { terminate(); }
+    };
+};
+
+// Starts a task from plain code, such as an event loop handler, and calls
+// done with its result wherever the task finishes
+template <typename T, typename Done>
+DetachedTask startTask(Task<T> task, Done done) {
+    done(co_await task);
+}
+
+// Join point of forked child coroutines. Created with the number of
+// children; the parent awaits it and the last child to arrive resumes it.
+class ForkJoin {
+private:
+    atomic<size_t> remaining;
+    coroutine_handle<> parent;
+    
+public:
+    // One extra count belongs to the parent until it suspends
+    explicit ForkJoin(size_t children) : remaining(children + 1) {}
+    
+    void arrive() {
+        if (remaining.fetch_sub(1, memory_order_acq_rel) == 1) {
+            parent.resume();
+        }
+    }
+    
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(coroutine_handle<> handle) noexcept {
+        parent = handle;
+        return remaining.fetch_sub(1, memory_order_acq_rel) > 1;
+    }
+    void await_resume() const noexcept {}
+};
+#endif // EARTHQUAKE_COROUTINES
+
+// How locateEpicenter turns stations into an estimate
+enum class LocateEngine {
+    triangulation,  // Divide & conquer over leaf centroids (reference)
+    grid_search     // Coarse-to-fine search of the travel-time misfit over the cells
+};
+
+class NodeResultCache;
+class BatchBackend;
+
+// Tunable locator settings
+struct LocatorConfig {
+    PartitionMode partition_mode;
+    const TriangulationKernels* kernels;  // nullptr = best for this CPU
+    
+    // ExecPolicy::parallel settings. Nodes at depth >= parallel_cutoff_depth
+    // or with <= parallel_cutoff_size stations recurse serially.
+    WorkStealingPool* pool;               // nullptr = locator-owned pool
+    size_t num_threads;                   // Size of the owned pool, 0 = all cores
+    int parallel_cutoff_depth;
+    size_t parallel_cutoff_size;
+    
+    // Back recursion temporaries (per-quadrant copies, quadrant lists, batch
+    // tiles) with a per-call ScratchArena instead of the global heap
+    bool use_arena;
+    size_t arena_initial_bytes;
+    
+    // Precision of the workspace that PartitionMode::in_place and morton load
+    // vector and view input into. float32 always uses the in-place partition;
+    // locateEpicenter(StationSet&) keeps the caller's double storage.
+    Precision precision;
+    
+    // Solve SoA leaves with the count-specialised solvers wherever they beat
+    // the kernel set in use (its fixed_leaf_limit). They keep the scalar
+    // summation order, so those leaves match the scalar kernels exactly.
+    bool fixed_size_leaves;
+    
+    // Recursion limits. A cell at max_depth, or whose sides are both narrower
+    // than min_cell_size degrees, is solved as one leaf however many stations
+    // it holds, so co-located stations cannot recurse without bound.
+    int max_depth;
+    double min_cell_size;                 // 0 = no size limit
+    
+    // Station-driven strategies adapt the cells to uneven networks, keeping
+    // depth near log4(n) and giving parallel tasks similar amounts of work
+    SplitStrategy split_strategy;
+    
+    // Branch and bound. A child whose earliest arrival lags the event's
+    // first arrival by more than the wave needs to cross the child, plus
+    // prune_tolerance seconds, cannot hold the epicenter under the travel-time
+    // model; prune_mode decides what happens to it.
+    PruneMode prune_mode;
+    double prune_tolerance;
+    
+    // Theoretical travel times of the leaf residuals; nullptr = straight-ray
+    // distance / WAVE_VELOCITY. The table must outlive the locator's calls.
+    const TravelTimeTable* travel_times;
+    
+    // CombineMode::summary carries EpicenterSummary moments up the tree
+    // instead of results, so the estimate is the pooled centroid of the
+    // leaves and its residual the pooled moveout misfit, whichever way the
+    // leaves are grouped. Like float32, it keeps vector input on the
+    // in-place partition (or Morton).
+    CombineMode combine_mode;
+    
+    // Memoized node estimates for batch locates against a StationNetwork;
+    // nullptr = off. With a cache the events of a batch are located one by
+    // one on the calling thread. The cache must outlive the locator's calls.
+    NodeResultCache* result_cache;
+    
+    // Offload target for batch locates against a StationNetwork; nullptr =
+    // CPU path, which is also the fallback when the backend fails. Ignored
+    // while result_cache is set.
+    BatchBackend* backend;
+    
+    // locateAsync: nodes shallower than async_depth are suspension points
+    // whose children run as separate tasks on the compute executor and
+    // check for cancellation; deeper subtrees run as one synchronous call
+    int async_depth;
+    
+    // LocateEngine::grid_search. Each level splits the grid_beam best cells
+    // into their midpoint quadrants and scores every child's center by the
+    // travel-time misfit of the stations at the best origin time, keeping
+    // the grid_beam best children. The search stops once cells are narrower
+    // than grid_resolution degrees (or at max_depth). The root level scores
+    // a strided sample of grid_sample stations (0 = all), doubling with each
+    // level as the cells shrink, and the final cells are scored against
+    // every station. Applies to single locates; batch and persistent paths
+    // keep the triangulation engine.
+    LocateEngine engine;
+    int grid_beam;
+    double grid_resolution;
+    size_t grid_sample;
+    
+    // Refine the combined estimate against every station with Gauss-Newton
+    // iterations (Geiger's method) on location and origin time. Stops when a
+    // step moves the location less than refine_tolerance degrees. The
+    // refinement uses the straight-ray model.
+    bool refine;
+    int refine_max_iterations;
+    double refine_tolerance;
+    
+    LocatorConfig() 
+        : partition_mode(PartitionMode::copy), kernels(nullptr), pool(nullptr), 
+          num_threads(0), parallel_cutoff_depth(4), parallel_cutoff_size(4096),
+          use_arena(false), arena_initial_bytes(64 * 1024), precision(Precision::float64),
+          fixed_size_leaves(true), max_depth(15), min_cell_size(0),
+          split_strategy(SplitStrategy::midpoint),
+          prune_mode(PruneMode::off), prune_tolerance(1.0), travel_times(nullptr),
+          combine_mode(CombineMode::result), result_cache(nullptr), backend(nullptr),
+          async_depth(3), engine(LocateEngine::triangulation), grid_beam(4), grid_resolution(0.01),
+          grid_sample(256), refine(false), refine_max_iterations(10), refine_tolerance(1e-4) {}
+};
+
+// Outcome of a Gauss-Newton refinement
+struct RefineReport {
+    int iterations;       // Accepted steps
+    bool converged;       // Last step was below the tolerance
+    double origin_time;   // Fitted event origin time
+    double initial_error; // Squared residuals at the starting point
+    
+    RefineReport() : iterations(0), converged(false), origin_time(0), initial_error(0) {}
+};
+
+// Outcome of a grid search
+struct GridSearchReport {
+    int levels;           // Levels descended below the root cell
+    size_t candidates;    // Cell centers scored
+    size_t evaluations;   // Station residuals computed over all candidates
+    
+    GridSearchReport() : levels(0), candidates(0), evaluations(0) {}
+};
+
+// Which path ran a batch locate against a StationNetwork
+struct BatchReport {
+    bool cached;          // Located through config.result_cache
+    bool offloaded;       // config.backend produced the results
+    bool fell_back;       // config.backend failed; the CPU path ran instead
+    string backend_error; // The backend's error when it fell back
+    
+    BatchReport() : cached(false), offloaded(false), fell_back(false) {}
+};
+
+class StationNetwork;
+typedef vector<double> ArrivalVector;  // Arrival times by station id; NaN = no pick
+
+// Earthquake Epicenter Locator using Divide & Conquer.
+// BaseCaseSize is the largest cell solved without splitting; deployments can
+// tune it at compile time. EarthquakeEpicenterLocator is the default of 8.
+template <int BaseCaseSize = 8>
+class BasicEpicenterLocator {
+    static_assert(BaseCaseSize >= 1, "base case must hold at least one station");
+    
+public:
+    static constexpr int BASE_CASE_SIZE = BaseCaseSize;  // Threshold for base case
+    static constexpr double WAVE_VELOCITY = 6.0;         // km/s (P-wave velocity)
+    
+private:
+    LocatorConfig config;
+    StationSet workspace;                // In-place copy of vector input
+    StationSet scratch;                  // Partition buffer reused across calls
+    FloatStationSet float_workspace;     // Same two for Precision::float32
+    FloatStationSet float_scratch;
+    vector<uint8_t> labels;              // Per-station quadrant index
+    vector<uint64_t> morton_keys;        // Sorted Z-order keys (PartitionMode::morton)
+    vector<uint64_t> key_scratch;
+    vector<uint32_t> order, order_scratch;
+    double first_arrival;                // Earliest detection of the call, for pruning
+    unique_ptr<WorkStealingPool> owned_pool;
+#ifdef EARTHQUAKE_INSTRUMENTATION
+    LocatorProfile profile;              // Filled by the last locate call
+#endif
+    
+public:
+    BasicEpicenterLocator(const LocatorConfig& _config = LocatorConfig()) 
+        : config(_config), first_arrival(0) {}
+    
+    const LocatorConfig& getConfig() const { return config; }
+    
+#ifdef EARTHQUAKE_INSTRUMENTATION
+    LocatorProfile& getProfile() { return profile; }
+#endif
+    
+    // Main divide and conquer algorithm
+    // In PartitionMode::in_place the stations are loaded once into a reusable
+    // SoA workspace and partitioned there; the caller's vector is untouched.
+    EpicenterResult locateEpicenter(vector<SeismicStation>& stations, 
+                                   const GeoBounds& bounds, 
+                                   int depth = 0) {
+        return locate(stations, bounds, depth, ExecPolicy::serial);
+    }
+    
+    // With ExecPolicy::parallel the quadrant subproblems above the configured
+    // cutoff run on a work-stealing pool. Results are combined in quadrant
+    // order, so they are bit-identical to the serial policy.
+    EpicenterResult locateEpicenter(vector<SeismicStation>& stations, 
+                                   const GeoBounds& bounds, 
+                                   ExecPolicy policy) {
+        return locate(stations, bounds, 0, policy);
+    }
+    
+    // Divide and conquer over SoA storage. The set is partitioned in place so
+    // that every quadtree node occupies a contiguous subrange of it.
+    EpicenterResult locateEpicenter(StationSet& stations, const GeoBounds& bounds,
+                                   ExecPolicy policy = ExecPolicy::serial) {
+        if (policy == ExecPolicy::parallel) {
+            threadPool();
+        }
+        return profiledCall(0, stations.size(), [&] {
+            if (config.engine == LocateEngine::grid_search) {
+                return refineCall(stations.view(), gridSearch(stations.view(), bounds));
+            }
+            EpicenterResult result = locateSet(stations, bounds, 0, policy);
+            return refineCall(stations.view(), result);
+        });
+    }
+    
+    // Float32 storage, partitioned in place like the StationSet overload.
+    // A configured refinement runs on a double copy of the stations.
+    EpicenterResult locateEpicenter(FloatStationSet& stations, const GeoBounds& bounds,
+                                   ExecPolicy policy = ExecPolicy::serial) {
+        if (policy == ExecPolicy::parallel) {
+            threadPool();
+        }
+        return profiledCall(0, stations.size(), [&] {
+            if (config.engine == LocateEngine::grid_search) {
+                workspace.assign(stations.view());
+                return refineCall(workspace.view(), gridSearch(workspace.view(), bounds));
+            }
+            EpicenterResult result = locateInPlace(stations, bounds, 0, policy);
+            if (!config.refine) {
+                return result;
+            }
+            workspace.assign(stations.view());
+            return refineCall(workspace.view(), result);
+        });
+    }
+    
+    // Locate many events against one prebuilt network; returns one result
+    // per event, identical to StationQuadtree::locate with scalar kernels.
+    // report tells whether the cache, the backend or the CPU path ran, and
+    // why a configured backend fell back.
+    vector<EpicenterResult> locateEpicenters(const StationNetwork& network,
+                                             Span<const ArrivalVector> events,
+                                             ExecPolicy policy = ExecPolicy::serial,
+                                             BatchReport* report = nullptr);
+    
+    // Locate from a read-only SoA view (e.g. a mapped StationCatalog). The
+    // columns are copied once into the workspace, then partitioned there.
+    EpicenterResult locateEpicenter(const StationSetView& stations, const GeoBounds& bounds,
+                                   ExecPolicy policy = ExecPolicy::serial) {
+        if (policy == ExecPolicy::parallel) {
+            threadPool();
+        }
+        return profiledCall(0, stations.size(), [&] {
+            if (config.engine == LocateEngine::grid_search) {
+                return refineCall(stations, gridSearch(stations, bounds));
+            }
+            EQ_PROFILE(auto setup_start = steady_clock::now());
+            if (config.precision == Precision::float32) {
+                float_workspace.assign(stations);
+                EQ_PROFILE(profile.record(LocatorProfile::setup, 0, stations.size(), setup_start, steady_clock::now()));
+                EpicenterResult result = locateInPlace(float_workspace, bounds, 0, policy);
+                return refineCall(stations, result);
+            }
+            workspace.assign(stations);
+            EQ_PROFILE(profile.record(LocatorProfile::setup, 0, stations.size(), setup_start, steady_clock::now()));
+            EpicenterResult result = locateSet(workspace, bounds, 0, policy);
+            return refineCall(workspace.view(), result);
+        });
+    }
+    
+    // One divide step at the root, without solving anything: splits bounds
+    // under the configured strategy and partitions stations in place by
+    // quadrant. counts, offsets and child_min hold 5 slots each, filled as by
+    // the recursive locate (slot 4 = outside all four quadrants).
+    void partitionRoot(StationSet& stations, const GeoBounds& bounds, size_t* counts, size_t* offsets,
+                       double* child_min) {
+        size_t n = stations.size();
+        scratch.resize(n);
+        labels.resize(n);
+        const double* lat = stations.latitude.data();
+        const double* lon = stations.longitude.data();
+        GeoBounds quadrants[4];
+        splitCell(bounds, 0, n, [lat](size_t i) { return lat[i]; }, [lon](size_t i) { return lon[i]; },
+                  scratch.latitude.data(), scratch.longitude.data(), quadrants);
+        partitionRange(stations, 0, n, quadrants, counts, offsets, child_min);
+    }
+    
+#ifdef EARTHQUAKE_COROUTINES
+    // Coroutine locate for event loops. The in-place locate of stations runs
+    // on compute, and every node shallower than config.async_depth forks its
+    // children there as separate tasks, so the locate can be abandoned
+    // between subtrees once stop is requested. The task completes on caller
+    // with the result, or nullopt if it was cancelled. The result equals
+    // locateEpicenter(StationSet&) with the same config in float64. Like the
+    // synchronous calls, one locate per locator at a time.
+    Task<optional<EpicenterResult>> locateAsync(vector<SeismicStation> stations, GeoBounds bounds,
+                                                Executor& compute, Executor& caller,
+                                                stop_token stop = stop_token()) {
+        co_await resumeOn(compute);
+        optional<EpicenterResult> result;
+        if (!stop.stop_requested()) {
+            workspace.assign(stations);
+            size_t n = workspace.size();
+            if (n == 0) {
+                result = simpleTriangulation(workspace.view());
+            } else {
+                scratch.resize(n);
+                labels.resize(n);
+                double min_time = minDetection(workspace.detection_time.data(), n);
+                first_arrival = min_time;
+                if (config.combine_mode == CombineMode::summary) {
+                    optional<EpicenterSummary> summary = 
+                        co_await locateRangeAsync<EpicenterSummary>(0, n, min_time, bounds, 0, compute, stop);
+                    if (summary) {
+                        result = summary->result();
+                    }
+                } else {
+                    result = co_await locateRangeAsync<EpicenterResult>(0, n, min_time, bounds, 0, compute, stop);
+                }
+                if (result && !stop.stop_requested()) {
+                    result = refineCall(workspace.view(), *result);
+                }
+            }
+        }
+        co_await resumeOn(caller);
+        co_return result;
+    }
+#endif
+    
+private:
+    EpicenterResult locate(vector<SeismicStation>& stations, const GeoBounds& bounds, 
+                           int depth, ExecPolicy policy) {
+        if (policy == ExecPolicy::parallel) {
+            threadPool();  // Create before any worker can ask for it
+        }
+        return profiledCall(depth, stations.size(), [&] {
+            if (config.engine == LocateEngine::grid_search) {
+                workspace.assign(stations);
+                return refineCall(workspace.view(), gridSearch(workspace.view(), bounds));
+            }
+            if (usesWorkspace() && config.precision == Precision::float32) {
+                EQ_PROFILE(auto setup_start = steady_clock::now());
+                float_workspace.assign(stations);
+                EQ_PROFILE(profile.record(LocatorProfile::setup, depth, stations.size(), 
+                                          setup_start, steady_clock::now()));
+                EpicenterResult result = locateInPlace(float_workspace, bounds, depth, policy);
+                if (!config.refine) {
+                    return result;
+                }
+                workspace.assign(stations);
+                return refineCall(workspace.view(), result);
+            }
+            if (usesWorkspace()) {
+                EQ_PROFILE(auto setup_start = steady_clock::now());
+                workspace.assign(stations);
+                EQ_PROFILE(profile.record(LocatorProfile::setup, depth, stations.size(), 
+                                          setup_start, steady_clock::now()));
+                EpicenterResult result = locateSet(workspace, bounds, depth, policy);
+                return refineCall(workspace.view(), result);
+            }
+            
+            first_arrival = numeric_limits<double>::infinity();
+            for (const auto& station : stations) {
+                first_arrival = min(first_arrival, station.detection_time);
+            }
+            
+            optional<ScratchArena> arena;
+            pmr::memory_resource* memory = pmr::new_delete_resource();
+            if (config.use_arena) {
+                arena.emplace(config.arena_initial_bytes);
+                memory = arena->resource();
+            }
+#ifdef EARTHQUAKE_INSTRUMENTATION
+            // Subtrees that open their own arena on another thread are not counted
+            CountingResource counting(memory);
+            EpicenterResult result = locateCopy(stations, bounds, depth, policy, &counting);
+            profile.addBytes(counting.bytesAllocated());
+#else
+            EpicenterResult result = locateCopy(stations, bounds, depth, policy, memory);
+#endif
+            if (!config.refine) {
+                return result;
+            }
+            workspace.assign(stations);  // The refinement reads SoA columns
+            return refineCall(workspace.view(), result);
+        });
+    }
+    
+    // Applies the configured refinement to a top-level estimate
+    EpicenterResult refineCall(const StationSetView& stations, const EpicenterResult& estimate) {
+        if (!config.refine) {
+            return estimate;
+        }
+        EQ_PROFILE_SCOPE(refine, 0, stations.size());
+        return refineEpicenter(stations, estimate);
+    }
+    
+    // Runs one top-level call. With instrumentation it starts a fresh
+    // profile, records the call span and adds the growth of the reusable
+    // SoA buffers to the bytes allocated.
+    template <typename Body>
+    EpicenterResult profiledCall(int depth, size_t stations, Body body) {
+#ifdef EARTHQUAKE_INSTRUMENTATION
+        profile.clear();
+        size_t buffers_before = bufferBytes();
+        EpicenterResult result;
+        {
+            ProfileScope scope(profile, LocatorProfile::call, depth, stations);
+            result = body();
+        }
+        profile.addBytes(bufferBytes() - buffers_before);
+        return result;
+#else
+        (void)depth;
+        (void)stations;
+        return body();
+#endif
+    }
+    
+#ifdef EARTHQUAKE_INSTRUMENTATION
+    // Capacity of the buffers kept across calls; they only ever grow
+    size_t bufferBytes() const {
+        auto bytes = [](const auto& buffer) { return buffer.capacity() * sizeof(buffer[0]); };
+        auto set_bytes = [&](const auto& set) {
+            return bytes(set.latitude) + bytes(set.longitude) + bytes(set.detection_time) + bytes(set.id);
+        };
+        return set_bytes(workspace) + set_bytes(scratch) + set_bytes(float_workspace) +
+               set_bytes(float_scratch) + bytes(labels) + bytes(morton_keys) +
+               bytes(key_scratch) + bytes(order) + bytes(order_scratch);
+    }
+#endif
+    
+    // Reference recursion: copies each quadrant's stations into its own vector.
+    // All of a node's temporaries come from memory; subtrees handed to other
+    // threads open their own arena since an arena is single-threaded.
+    EpicenterResult locateCopy(Span<const SeismicStation> stations, const GeoBounds& bounds, 
+                               int depth, ExecPolicy policy, pmr::memory_resource* memory) {
+        
+        // Base case: use simple triangulation
+        if (isLeafCell(stations.size(), bounds, depth)) {
+            EQ_PROFILE_SCOPE(leaf, depth, stations.size());
+            return simpleTriangulation(stations);
+        }
+        
+        // Divide: Split geographic region into quadrants
+        EQ_PROFILE(auto partition_start = steady_clock::now());
+        GeoBounds cells[4];
+        {
+            size_t n = stations.size();
+            pmr::vector<double> buffer(splitUsesStations() ? 2 * n : 0, memory);
+            splitCell(bounds, depth, n,
+                      [&](size_t i) { return stations[i].latitude; },
+                      [&](size_t i) { return stations[i].longitude; },
+                      buffer.data(), buffer.data() + n, cells);
+        }
+        
+        pmr::vector<Quadrant> quadrants({
+            Quadrant(cells[0]), Quadrant(cells[1]), Quadrant(cells[2]), Quadrant(cells[3])
+        }, memory);
+        
+        // Partition stations into quadrants
+        pmr::vector<SeismicStation> quadrant_stations[4] = {
+            pmr::vector<SeismicStation>(memory), pmr::vector<SeismicStation>(memory),
+            pmr::vector<SeismicStation>(memory), pmr::vector<SeismicStation>(memory)
+        };
+        double child_min[4];
+        fill(child_min, child_min + 4, numeric_limits<double>::infinity());
+        for (auto& station : stations) {
+            int q = quadrantIndex(quadrants.data(), station);
+            if (q < 4) {
+                quadrant_stations[q].push_back(station);
+                child_min[q] = min(child_min[q], station.detection_time);
+            }
+        }
+        
+        // Recursively solve for each quadrant with stations, then combine:
+        // weighted average of regional estimates
+        size_t counts[4];
+        for (int q = 0; q < 4; q++) {
+            quadrants[q].stations = StationSpan(quadrant_stations[q]);
+            counts[q] = quadrant_stations[q].size();
+        }
+        EQ_PROFILE(profile.record(LocatorProfile::partition, depth, stations.size(), 
+                                  partition_start, steady_clock::now()));
+        
+        bool pruned[4];
+        if (!pruneQuadrants(cells, child_min, counts, pruned)) {
+            EQ_PROFILE_SCOPE(leaf, depth, stations.size());
+            return simpleTriangulation(stations);
+        }
+        
+        bool parallel = spawnQuadrants(policy, depth, stations.size());
+        bool task_arenas = parallel && config.use_arena;
+        return solveQuadrants(counts, depth, parallel, [&](int q) {
+            Quadrant& quad = quadrants[q];
+            EpicenterResult result;
+            if (pruned[q]) {
+                EQ_PROFILE_SCOPE(leaf, depth + 1, counts[q]);
+                result = simpleTriangulation(quad.stations);
+            } else if (task_arenas) {
+                ScratchArena arena(config.arena_initial_bytes);
+                result = locateCopy(quadrant_stations[q], quad.bounds, depth + 1, policy, arena.resource());
+            } else {
+                result = locateCopy(quadrant_stations[q], quad.bounds, depth + 1, policy, memory);
+            }
+            quad.estimate = result.location;
+            quad.confidence = result.confidence;
+            return result;
+        });
+    }
+    
+    WorkStealingPool& threadPool() {
+        if (config.pool) {
+            return *config.pool;
+        }
+        if (!owned_pool) {
+            owned_pool.reset(new WorkStealingPool(config.num_threads));
+        }
+        return *owned_pool;
+    }
+    
+    bool spawnQuadrants(ExecPolicy policy, int depth, size_t count) const {
+        return policy == ExecPolicy::parallel && depth < config.parallel_cutoff_depth &&
+               count > config.parallel_cutoff_size;
+    }
+    
+    // Solves every quadrant with stations and combines the results in
+    // quadrant order. When parallel, all but the last quadrant go to the pool
+    // and this thread works on the last one, then helps until all are done.
+    // Each result has a fixed slot, so the combine matches the serial one.
+    template <typename Solve>
+    auto solveQuadrants(const size_t* counts, int depth, bool parallel, Solve solve) -> decltype(solve(0)) {
+        typedef decltype(solve(0)) Estimate;
+        Estimate slots[4];
+        if (parallel) {
+            int last = -1;
+            for (int q = 0; q < 4; q++) {
+                if (counts[q] > 0) {
+                    last = q;
+                }
+            }
+            TaskGroup group(threadPool());
+            for (int q = 0; q < last; q++) {
+                if (counts[q] > 0) {
+                    group.run([&slots, &solve, q] { slots[q] = solve(q); });
+                }
+            }
+            if (last >= 0) {
+                slots[last] = solve(last);
+            }
+            group.wait();
+        } else {
+            for (int q = 0; q < 4; q++) {
+                if (counts[q] > 0) {
+                    slots[q] = solve(q);
+                }
+            }
+        }
+        
+        return combineSlots(counts, slots, depth);
+    }
+    
+    // Combines the slots of the quadrants with stations, in quadrant order
+    template <typename Estimate>
+    Estimate combineSlots(const size_t* counts, const Estimate* slots, int depth) {
+        Estimate results[4];
+        size_t num_results = 0;
+        for (int q = 0; q < 4; q++) {
+            if (counts[q] > 0) {
+                results[num_results++] = slots[q];
+            }
+        }
+        (void)depth;
+        EQ_PROFILE_SCOPE(combine, depth, num_results);
+        return combineEstimates(Span<const Estimate>(results, num_results));
+    }
+    
+    // Leaf solve and combine of the SoA recursions per estimate type:
+    // EpicenterResult for CombineMode::result, EpicenterSummary for summary
+    template <typename View>
+    EpicenterResult leafEstimate(const View& stations, double min_time, EpicenterResult*) const {
+        return simpleTriangulation(stations, min_time);
+    }
+    
+    template <typename View>
+    EpicenterSummary leafEstimate(const View& stations, double min_time, EpicenterSummary*) const {
+        return summarize(stations, min_time);
+    }
+    
+    template <typename View>
+    EpicenterResult leafEstimate(const View& stations, EpicenterResult*) const {
+        return simpleTriangulation(stations);
+    }
+    
+    template <typename View>
+    EpicenterSummary leafEstimate(const View& stations, EpicenterSummary*) const {
+        return summarize(stations);
+    }
+    
+    EpicenterResult combineEstimates(Span<const EpicenterResult> results) const {
+        return weightedCombination(results);
+    }
+    
+    EpicenterSummary combineEstimates(Span<const EpicenterSummary> summaries) const {
+        EpicenterSummary combined;
+        for (const auto& summary : summaries) {
+            combined.merge(summary);
+        }
+        return combined;
+    }
+    
+    // Vector input goes through the SoA workspace unless the copy path applies
+    bool usesWorkspace() const {
+        return config.partition_mode != PartitionMode::copy || config.combine_mode == CombineMode::summary;
+    }
+
+    // Index of the first quadrant containing the station, or 4 if none does.
+    // First match wins so stations on a shared edge land in exactly one quadrant.
+    // All four tests are evaluated and the first set bit is looked up, so
+    // there is no data-dependent branch.
+    static int quadrantIndex(const Quadrant* quadrants, const SeismicStation& station) {
+        const GeoBounds cells[4] = {quadrants[0].bounds, quadrants[1].bounds, 
+                                    quadrants[2].bounds, quadrants[3].bounds};
+        return quadrantIndex(cells, station.latitude, station.longitude);
+    }
+    
+    static int quadrantIndex(const GeoBounds* quadrants, double lat, double lon) {
+        static const uint8_t FIRST_MATCH[16] = {4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0};
+        unsigned mask = quadrants[0].containsBit(lat, lon) |
+                        quadrants[1].containsBit(lat, lon) << 1 |
+                        quadrants[2].containsBit(lat, lon) << 2 |
+                        quadrants[3].containsBit(lat, lon) << 3;
+        return FIRST_MATCH[mask];
+    }
+    
+    const TriangulationKernels& kernels() const {
+        return config.kernels ? *config.kernels : TriangulationKernels::best();
+    }
+    
+    const FloatTriangulationKernels& floatKernels() const {
+        return FloatTriangulationKernels::matching(kernels());
+    }
+    
+    // Z-order keys encode the midpoint quadtree only, so other split
+    // strategies use the in-place partition even in PartitionMode::morton
+    EpicenterResult locateSet(StationSet& stations, const GeoBounds& bounds, int depth,
+                              ExecPolicy policy) {
+        if (config.partition_mode == PartitionMode::morton && 
+            config.split_strategy == SplitStrategy::midpoint) {
+            return locateMorton(stations, bounds, depth, policy);
+        }
+        return locateInPlace(stations, bounds, depth, policy);
+    }
+    
+    // The in-place path is shared by both precisions; these pick the
+    // partition buffer and the minimum kernel of a storage type
+    StationSet& scratchFor(const StationSet&) { return scratch; }
+    FloatStationSet& scratchFor(const FloatStationSet&) { return float_scratch; }
+    
+    double minDetection(const double* time, size_t n) const { return kernels().minTime(time, n); }
+    double minDetection(const float* time, size_t n) const { return floatKernels().minTime(time, n); }
+    
+    template <typename Real>
+    EpicenterResult locateInPlace(BasicStationSet<Real>& stations, const GeoBounds& bounds, int depth,
+                                  ExecPolicy policy) {
+        size_t n = stations.size();
+        if (n == 0) {
+            return simpleTriangulation(stations.view());
+        }
+        
+        // Only allocations of the call; capacity is reused on later calls
+        EQ_PROFILE(auto setup_start = steady_clock::now());
+        scratchFor(stations).resize(n);
+        labels.resize(n);
+        
+        double min_time = minDetection(stations.detection_time.data(), n);
+        first_arrival = min_time;
+        EQ_PROFILE(profile.record(LocatorProfile::setup, depth, n, setup_start, steady_clock::now()));
+        if (config.combine_mode == CombineMode::summary) {
+            return locateRange<EpicenterSummary>(stations, 0, n, min_time, bounds, depth, policy).result();
+        }
+        return locateRange<EpicenterResult>(stations, 0, n, min_time, bounds, depth, policy);
+    }
+    
+    // Stable 4-way partition of stations[first, first + count) by quadrant.
+    // Outputs per quadrant (slot 4 = outside all four): station count, offset
+    // of its subrange relative to first, and earliest detection time.
+    template <typename Real>
+    void partitionRange(BasicStationSet<Real>& stations, size_t first, size_t count, 
+                        const GeoBounds* quadrants, size_t* counts, size_t* offsets, 
+                        double* child_min) {
+        labelRange(stations, first, count, quadrants, counts, offsets, child_min);
+        scatterRange(stations, first, count, offsets);
+    }
+    
+    // First half of partitionRange: labels each station with its quadrant
+    // and fills the outputs, leaving the stations in their order
+    template <typename Real>
+    void labelRange(const BasicStationSet<Real>& stations, size_t first, size_t count, 
+                    const GeoBounds* quadrants, size_t* counts, size_t* offsets, double* child_min) {
+        const Real* lat = stations.latitude.data() + first;
+        const Real* lon = stations.longitude.data() + first;
+        const Real* time = stations.detection_time.data() + first;
+        uint8_t* label = labels.data() + first;
+        
+        // Stable 4-way partition (counting sort): stations outside every
+        // quadrant go to slot 4 at the tail and are not recursed into.
+        // Midpoint and median cells form a 2x2 grid, where the first-match
+        // index is (lat > cut_lat) << 1 | (lon > cut_lon) for stations inside
+        // the node: stations on a cut go to the lower cell as before.
+        bool grid = config.split_strategy == SplitStrategy::midpoint ||
+                    config.split_strategy == SplitStrategy::median;
+        if (grid) {
+            double cut_lat = quadrants[0].max_lat, cut_lon = quadrants[0].max_lon;
+            GeoBounds node(quadrants[0].min_lat, quadrants[3].max_lat, 
+                           quadrants[0].min_lon, quadrants[3].max_lon);
+            for (size_t i = 0; i < count; i++) {
+                unsigned q = unsigned(lat[i] > cut_lat) << 1 | unsigned(lon[i] > cut_lon);
+                label[i] = static_cast<uint8_t>(node.containsBit(lat[i], lon[i]) ? q : 4);
+            }
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                label[i] = static_cast<uint8_t>(quadrantIndex(quadrants, lat[i], lon[i]));
+            }
+        }
+        // Each quadrant's earliest detection comes along, so the leaves can
+        // skip their min-time pass and pruning can run before the scatter
+        fill(counts, counts + 5, size_t(0));
+        fill(child_min, child_min + 5, numeric_limits<double>::infinity());
+        for (size_t i = 0; i < count; i++) {
+            counts[label[i]]++;
+            child_min[label[i]] = min(child_min[label[i]], static_cast<double>(time[i]));
+        }
+        
+        size_t running = 0;
+        for (int q = 0; q < 5; q++) {
+            offsets[q] = running;
+            running += counts[q];
+        }
+    }
+    
+    // Second half: stable scatter of the labelled stations into quadrant order
+    template <typename Real>
+    void scatterRange(BasicStationSet<Real>& stations, size_t first, size_t count, const size_t* offsets) {
+        Real* lat = stations.latitude.data() + first;
+        Real* lon = stations.longitude.data() + first;
+        Real* time = stations.detection_time.data() + first;
+        int* id = stations.id.data() + first;
+        const uint8_t* label = labels.data() + first;
+        BasicStationSet<Real>& buffer = scratchFor(stations);
+        Real* scratch_lat = buffer.latitude.data() + first;
+        Real* scratch_lon = buffer.longitude.data() + first;
+        Real* scratch_time = buffer.detection_time.data() + first;
+        int* scratch_id = buffer.id.data() + first;
+        
+        size_t cursor[5];
+        copy(offsets, offsets + 5, cursor);
+        for (size_t i = 0; i < count; i++) {
+            size_t dst = cursor[label[i]]++;
+            scratch_lat[dst] = lat[i];
+            scratch_lon[dst] = lon[i];
+            scratch_time[dst] = time[i];
+            scratch_id[dst] = id[i];
+        }
+        copy(scratch_lat, scratch_lat + count, lat);
+        copy(scratch_lon, scratch_lon + count, lon);
+        copy(scratch_time, scratch_time + count, time);
+        copy(scratch_id, scratch_id + count, id);
+    }
+    
+    // Divide step of locateRange: splits the node's cell, partitions its
+    // subrange (outputs as partitionRange) and marks the pruned children.
+    // Returns false when branch and bound leaves the node as one leaf; the
+    // subrange is then left in its order, so the leaf sums run as in the
+    // copy path.
+    template <typename Real>
+    bool divideRange(BasicStationSet<Real>& stations, size_t first, size_t count, const GeoBounds& bounds,
+                     int depth, GeoBounds* quadrants, size_t* counts, size_t* offsets, 
+                     double* child_min, bool* pruned) {
+        // The node's subrange of scratch is free until the partition pass
+        EQ_PROFILE(auto partition_start = steady_clock::now());
+        const Real* lat = stations.latitude.data() + first;
+        const Real* lon = stations.longitude.data() + first;
+        BasicStationSet<Real>& buffer = scratchFor(stations);
+        splitCell(bounds, depth, count,
+                  [lat](size_t i) { return lat[i]; }, [lon](size_t i) { return lon[i]; },
+                  buffer.latitude.data() + first, buffer.longitude.data() + first, quadrants);
+        
+        labelRange(stations, first, count, quadrants, counts, offsets, child_min);
+        bool divided = pruneQuadrants(quadrants, child_min, counts, pruned);
+        if (divided) {
+            scatterRange(stations, first, count, offsets);
+        }
+        EQ_PROFILE(profile.record(LocatorProfile::partition, depth, count, partition_start, steady_clock::now()));
+        return divided;
+    }
+    
+    // Divide & conquer over stations[first, first + count) of one shared SoA
+    // buffer. A node only touches the matching subrange of scratch and labels,
+    // so no allocation happens below the root and sibling subtrees can run
+    // on different threads. min_time is the earliest detection in the range,
+    // gathered by the parent's partition pass.
+    template <typename Estimate, typename Real>
+    Estimate locateRange(BasicStationSet<Real>& stations, size_t first, size_t count, 
+                         double min_time, const GeoBounds& bounds, int depth, ExecPolicy policy) {
+        Estimate* tag = nullptr;
+        if (isLeafCell(count, bounds, depth)) {
+            EQ_PROFILE_SCOPE(leaf, depth, count);
+            return leafEstimate(stations.view(first, count), min_time, tag);
+        }
+        
+        GeoBounds quadrants[4];
+        size_t counts[5], offsets[5];
+        double child_min[5];
+        bool pruned[4];
+        if (!divideRange(stations, first, count, bounds, depth, quadrants, counts, offsets, child_min, pruned)) {
+            EQ_PROFILE_SCOPE(leaf, depth, count);
+            return leafEstimate(stations.view(first, count), min_time, tag);
+        }
+        
+        // Recurse on each non-empty subrange
+        bool parallel = spawnQuadrants(policy, depth, count);
+        return solveQuadrants(counts, depth, parallel, [&](int q) {
+            if (pruned[q]) {
+                EQ_PROFILE_SCOPE(leaf, depth + 1, counts[q]);
+                return leafEstimate(stations.view(first + offsets[q], counts[q]), child_min[q], tag);
+            }
+            return locateRange<Estimate>(stations, first + offsets[q], counts[q], child_min[q], 
+                                         quadrants[q], depth + 1, policy);
+        });
+    }
+    
+#ifdef EARTHQUAKE_COROUTINES
+    // locateRange on the workspace for locateAsync. Above async_depth each
+    // non-empty child becomes its own task on compute; the combine waits for
+    // all of them and gives up (nullopt) if any was cancelled. Below it the
+    // subtree is one synchronous locateRange.
+    template <typename Estimate>
+    Task<optional<Estimate>> locateRangeAsync(size_t first, size_t count, double min_time, 
+                                              GeoBounds bounds, int depth, Executor& compute,
+                                              stop_token stop) {
+        Estimate* tag = nullptr;
+        if (stop.stop_requested()) {
+            co_return nullopt;
+        }
+        if (depth >= config.async_depth || isLeafCell(count, bounds, depth)) {
+            co_return locateRange<Estimate>(workspace, first, count, min_time, bounds, depth, 
+                                            ExecPolicy::serial);
+        }
+        
+        GeoBounds quadrants[4];
+        size_t counts[5], offsets[5];
+        double child_min[5];
+        bool pruned[4];
+        if (!divideRange(workspace, first, count, bounds, depth, quadrants, counts, offsets, child_min, pruned)) {
+            co_return leafEstimate(workspace.view(first, count), min_time, tag);
+        }
+        
+        optional<Estimate> slots[4];
+        ForkJoin join(static_cast<size_t>(count_if(counts, counts + 4, [](size_t c) { return c > 0; })));
+        for (int q = 0; q < 4; q++) {
+            if (counts[q] == 0) {
+                continue;
+            }
+            if (pruned[q]) {
+                slots[q] = leafEstimate(workspace.view(first + offsets[q], counts[q]), child_min[q], tag);
+                join.arrive();
+            } else {
+                forkChild(locateRangeAsync<Estimate>(first + offsets[q], counts[q], child_min[q], 
+                                                     quadrants[q], depth + 1, compute, stop),
+                          compute, slots[q], join);
+            }
+        }
+        co_await join;
+        
+        Estimate results[4];
+        for (int q = 0; q < 4; q++) {
+            if (counts[q] > 0) {
+                if (!slots[q]) {
+                    co_return nullopt;
+                }
+                results[q] = *slots[q];
+            }
+        }
+        co_return combineSlots(counts, results, depth);
+    }
+    
+    // Runs child on compute, stores its outcome in slot and arrives at join
+    template <typename Estimate>
+    static DetachedTask forkChild(Task<optional<Estimate>> child, Executor& compute, 
+                                  optional<Estimate>& slot, ForkJoin& join) {
+        co_await resumeOn(compute);
+        slot = co_await child;
+        join.arrive();
+    }
+#endif
+    
+    // Time for the wave to cross a cell corner to corner
+    double crossingTime(const GeoBounds& cell) const {
+        double height = cell.max_lat - cell.min_lat;
+        double width = cell.max_lon - cell.min_lon;
+        if (config.travel_times) {
+            return config.travel_times->travelTime(height, width);
+        }
+        return sqrt(height * height + width * width) / WAVE_VELOCITY;
+    }
+    
+    // Branch and bound over a node's children. A non-empty child is ruled out
+    // when its lower-bound residual, the lag of its earliest arrival behind
+    // first_arrival less the crossing time, exceeds prune_tolerance: an
+    // epicenter inside it would have reached one of its stations sooner.
+    // Ruled-out children are marked in pruned, and in PruneMode::skip their
+    // counts are zeroed. Returns false when skip rules out every child, in
+    // which case the caller solves the node as one leaf.
+    bool pruneQuadrants(const GeoBounds* cells, const double* child_min, size_t* counts, bool* pruned) {
+        fill(pruned, pruned + 4, false);
+        if (config.prune_mode == PruneMode::off) {
+            return true;
+        }
+        int num_pruned = 0, remaining = 0;
+        for (int q = 0; q < 4; q++) {
+            if (counts[q] == 0) {
+                continue;
+            }
+            double lower_bound = child_min[q] - first_arrival - crossingTime(cells[q]);
+            if (lower_bound > config.prune_tolerance) {
+                pruned[q] = true;
+                num_pruned++;
+            } else {
+                remaining++;
+            }
+        }
+        EQ_PROFILE(if (num_pruned > 0) profile.addPruned(num_pruned));
+        if (config.prune_mode != PruneMode::skip) {
+            return true;
+        }
+        if (num_pruned > 0 && remaining == 0) {
+            return false;
+        }
+        for (int q = 0; q < 4; q++) {
+            counts[q] = pruned[q] ? 0 : counts[q];
+        }
+        return true;
+    }
+    
+    // Morton keys cover at most this many levels below the root (two bits
+    // each), leaving room for the out-of-bounds sentinel
+    static constexpr int MORTON_MAX_LEVELS = 31;
+    
+    // Spreads the low 32 bits of v to the even bit positions
+    static uint64_t spreadBits(uint64_t v) {
+        v &= 0xffffffffULL;
+        v = (v | (v << 16)) & 0x0000ffff0000ffffULL;
+        v = (v | (v << 8))  & 0x00ff00ff00ff00ffULL;
+        v = (v | (v << 4))  & 0x0f0f0f0f0f0f0f0fULL;
+        v = (v | (v << 2))  & 0x3333333333333333ULL;
+        v = (v | (v << 1))  & 0x5555555555555555ULL;
+        return v;
+    }
+    
+    // Cell of coordinate v on a 2^levels grid over [lo, hi]. A value on a
+    // cell edge goes to the lower cell, like the first-match partition.
+    static uint64_t gridCell(double v, double lo, double hi, int levels) {
+        double cells = static_cast<double>(uint64_t(1) << levels);
+        double scaled = hi > lo ? (v - lo) / (hi - lo) * cells : 0;
+        return static_cast<uint64_t>(min(max(ceil(scaled) - 1, 0.0), cells - 1));
+    }
+    
+    // Sorts stations by Z-order key within bounds (2 bits per level, latitude
+    // bit first, so digit order is SW, SE, NW, NE as in splitCell) and
+    // recurses on key ranges. Stations outside bounds sort to the tail and
+    // are skipped. Cells are aligned to the root's 2^levels grid rather than
+    // recomputed midpoints, so a station within rounding distance of a split
+    // line can land on the other side than with the contains() partition.
+    EpicenterResult locateMorton(StationSet& stations, const GeoBounds& bounds, int depth,
+                                 ExecPolicy policy) {
+        size_t n = stations.size();
+        int levels = min(max(config.max_depth - depth, 0), MORTON_MAX_LEVELS);
+        if (levels == 0 || isLeafCell(n, bounds, depth)) {
+            EQ_PROFILE_SCOPE(leaf, depth, n);
+            return simpleTriangulation(stations.view());  // Root leaf keeps outside stations
+        }
+        EQ_PROFILE(auto setup_start = steady_clock::now());
+        uint64_t outside = uint64_t(1) << (2 * levels);
+        
+        morton_keys.resize(n);
+        key_scratch.resize(n);
+        order.resize(n);
+        order_scratch.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            double lat = stations.latitude[i], lon = stations.longitude[i];
+            morton_keys[i] = !bounds.contains(lat, lon) ? outside :
+                (spreadBits(gridCell(lat, bounds.min_lat, bounds.max_lat, levels)) << 1) |
+                 spreadBits(gridCell(lon, bounds.min_lon, bounds.max_lon, levels));
+            order[i] = static_cast<uint32_t>(i);
+        }
+        
+        // Stable LSD radix sort of (key, index), one byte per pass; passes
+        // where every key has the same digit are skipped
+        int key_bits = 2 * levels + 1;
+        for (int shift = 0; shift < key_bits; shift += 8) {
+            size_t counts[256] = {};
+            for (size_t i = 0; i < n; i++) {
+                counts[(morton_keys[i] >> shift) & 0xff]++;
+            }
+            if (counts[(morton_keys[0] >> shift) & 0xff] == n) {
+                continue;
+            }
+            size_t running = 0;
+            for (size_t& count : counts) {
+                size_t c = count;
+                count = running;
+                running += c;
+            }
+            for (size_t i = 0; i < n; i++) {
+                size_t dst = counts[(morton_keys[i] >> shift) & 0xff]++;
+                key_scratch[dst] = morton_keys[i];
+                order_scratch[dst] = order[i];
+            }
+            morton_keys.swap(key_scratch);
+            order.swap(order_scratch);
+        }
+        
+        // Gather into key order in scratch, then copy back so the caller's
+        // set ends up sorted in its own buffers; swapping them in would hand
+        // the caller storage that the next locate overwrites
+        scratch.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            uint32_t src = order[i];
+            scratch.latitude[i] = stations.latitude[src];
+            scratch.longitude[i] = stations.longitude[src];
+            scratch.detection_time[i] = stations.detection_time[src];
+            scratch.id[i] = stations.id[src];
+        }
+        stations.assign(scratch.view());
+        
+        size_t inside = lower_bound(morton_keys.begin(), morton_keys.end(), outside) - morton_keys.begin();
+        if (config.prune_mode != PruneMode::off) {
+            first_arrival = kernels().minTime(stations.detection_time.data(), n);
+        }
+        EQ_PROFILE(profile.record(LocatorProfile::setup, depth, n, setup_start, steady_clock::now()));
+        if (config.combine_mode == CombineMode::summary) {
+            return splitKeyRange<EpicenterSummary>(stations, 0, inside, levels, bounds, depth, policy, n).result();
+        }
+        return splitKeyRange<EpicenterResult>(stations, 0, inside, levels, bounds, depth, policy, n);
+    }
+    
+    // stations[first, first + count) share the key prefix of the cell bounds;
+    // levels is the number of key digits below it
+    template <typename Estimate>
+    Estimate locateKeyRange(StationSet& stations, size_t first, size_t count, int levels,
+                            const GeoBounds& bounds, int depth, ExecPolicy policy) {
+        if (levels == 0 || isLeafCell(count, bounds, depth)) {
+            EQ_PROFILE_SCOPE(leaf, depth, count);
+            return leafEstimate(stations.view(first, count), static_cast<Estimate*>(nullptr));
+        }
+        return splitKeyRange<Estimate>(stations, first, count, levels, bounds, depth, policy, count);
+    }
+    
+    // Recurses on the four children of a cell that is split. node_size is
+    // the cell's station count for the parallel cutoff, which at the root
+    // includes stations outside bounds.
+    template <typename Estimate>
+    Estimate splitKeyRange(StationSet& stations, size_t first, size_t count, int levels,
+                           const GeoBounds& bounds, int depth, ExecPolicy policy, size_t node_size) {
+        Estimate* tag = nullptr;
+        EQ_PROFILE(auto partition_start = steady_clock::now());
+        GeoBounds quadrants[4];
+        splitCell(bounds, depth, count, [](size_t) { return 0.0; }, [](size_t) { return 0.0; },
+                  static_cast<double*>(nullptr), static_cast<double*>(nullptr), quadrants);
+        
+        // Child ranges by the key digit at this level
+        int shift = 2 * (levels - 1);
+        const uint64_t* keys = morton_keys.data() + first;
+        size_t offsets[5];
+        offsets[0] = 0;
+        offsets[4] = count;
+        for (uint64_t q = 1; q < 4; q++) {
+            offsets[q] = partition_point(keys + offsets[q - 1], keys + count, [shift, q](uint64_t key) {
+                return ((key >> shift) & 3) < q;
+            }) - keys;
+        }
+        size_t counts[4];
+        for (int q = 0; q < 4; q++) {
+            counts[q] = offsets[q + 1] - offsets[q];
+        }
+        // Key ranges carry no arrival summary; pruning pays one min pass per child
+        double child_min[4];
+        if (config.prune_mode != PruneMode::off) {
+            const double* time = stations.detection_time.data() + first;
+            for (int q = 0; q < 4; q++) {
+                child_min[q] = counts[q] ? kernels().minTime(time + offsets[q], counts[q]) : 0.0;
+            }
+        }
+        EQ_PROFILE(profile.record(LocatorProfile::partition, depth, count, partition_start, steady_clock::now()));
+        
+        bool pruned[4];
+        if (!pruneQuadrants(quadrants, child_min, counts, pruned)) {
+            EQ_PROFILE_SCOPE(leaf, depth, node_size);
+            return leafEstimate(stations.view(first, node_size), tag);
+        }
+        
+        bool parallel = spawnQuadrants(policy, depth, node_size);
+        return solveQuadrants(counts, depth, parallel, [&](int q) {
+            if (pruned[q]) {
+                EQ_PROFILE_SCOPE(leaf, depth + 1, counts[q]);
+                return leafEstimate(stations.view(first + offsets[q], counts[q]), tag);
+            }
+            return locateKeyRange<Estimate>(stations, first + offsets[q], counts[q], levels - 1,
+                                            quadrants[q], depth + 1, policy);
+        });
+    }
+    
+public:
+    // Leaf solver and combine step; also used by the persistent structures
+    // below so that they reproduce locateEpicenter exactly
+    
+    // Whether a cell is solved directly instead of being split further
+    bool isLeafCell(size_t count, const GeoBounds& bounds, int depth) const {
+        if (count <= BASE_CASE_SIZE || depth >= config.max_depth) {
+            return true;
+        }
+        return bounds.max_lat - bounds.min_lat < config.min_cell_size &&
+               bounds.max_lon - bounds.min_lon < config.min_cell_size;
+    }
+    
+    // Whether splitCell reads station coordinates (and needs its buffers)
+    bool splitUsesStations() const {
+        return config.split_strategy != SplitStrategy::midpoint;
+    }
+    
+    // The four child cells of bounds under the configured SplitStrategy. They
+    // tile bounds and are tested in order by the first-match partition.
+    // lat(i) and lon(i) give the coordinates of the cell's count stations;
+    // buffer_a and buffer_b each hold count values of selection workspace and
+    // may be null for the midpoint strategy.
+    template <typename Lat, typename Lon, typename Value>
+    void splitCell(const GeoBounds& b, int depth, size_t count, Lat lat, Lon lon,
+                   Value* buffer_a, Value* buffer_b, GeoBounds* cells) const {
+        double mid_lat = (b.min_lat + b.max_lat) / 2;
+        double mid_lon = (b.min_lon + b.max_lon) / 2;
+        
+        switch (count == 0 ? SplitStrategy::midpoint : config.split_strategy) {
+        case SplitStrategy::midpoint:
+            break;
+            
+        case SplitStrategy::median:
+            for (size_t i = 0; i < count; i++) {
+                buffer_a[i] = lat(i);
+                buffer_b[i] = lon(i);
+            }
+            mid_lat = orderStatistic(buffer_a, count, (count - 1) / 2, b.min_lat, b.max_lat);
+            mid_lon = orderStatistic(buffer_b, count, (count - 1) / 2, b.min_lon, b.max_lon);
+            break;
+            
+        case SplitStrategy::kd: {
+            bool along_lat = depth % 2 == 0;
+            double lo = along_lat ? b.min_lat : b.min_lon;
+            double hi = along_lat ? b.max_lat : b.max_lon;
+            for (size_t i = 0; i < count; i++) {
+                buffer_a[i] = along_lat ? lat(i) : lon(i);
+            }
+            double cuts[5] = {lo, 0, 0, 0, hi};
+            for (int k = 1; k < 4; k++) {
+                cuts[k] = orderStatistic(buffer_a, count, k * (count - 1) / 4, lo, hi);
+            }
+            for (int k = 0; k < 4; k++) {
+                cells[k] = along_lat ? GeoBounds(cuts[k], cuts[k + 1], b.min_lon, b.max_lon)
+                                     : GeoBounds(b.min_lat, b.max_lat, cuts[k], cuts[k + 1]);
+            }
+            return;
+        }
+            
+        case SplitStrategy::balanced: {
+            bool along_lat = b.max_lat - b.min_lat >= b.max_lon - b.min_lon;
+            double lo = along_lat ? b.min_lat : b.min_lon;
+            double hi = along_lat ? b.max_lat : b.max_lon;
+            double other_lo = along_lat ? b.min_lon : b.min_lat;
+            double other_hi = along_lat ? b.max_lon : b.max_lat;
+            for (size_t i = 0; i < count; i++) {
+                buffer_a[i] = along_lat ? lat(i) : lon(i);
+            }
+            double cut = orderStatistic(buffer_a, count, (count - 1) / 2, lo, hi);
+            
+            // Other coordinate of the lower half (on the cut included, as
+            // the first match puts it there) at the front, upper at the back
+            size_t lower = 0, upper = count;
+            for (size_t i = 0; i < count; i++) {
+                double a = along_lat ? lat(i) : lon(i);
+                double other = along_lat ? lon(i) : lat(i);
+                if (a <= cut) {
+                    buffer_b[lower++] = other;
+                } else {
+                    buffer_b[--upper] = other;
+                }
+            }
+            double other_mid = (other_lo + other_hi) / 2;
+            double cut_low = lower == 0 ? other_mid :
+                orderStatistic(buffer_b, lower, (lower - 1) / 2, other_lo, other_hi);
+            double cut_high = upper == count ? other_mid :
+                orderStatistic(buffer_b + upper, count - upper, (count - upper - 1) / 2, other_lo, other_hi);
+            
+            if (along_lat) {
+                cells[0] = GeoBounds(b.min_lat, cut, b.min_lon, cut_low);
+                cells[1] = GeoBounds(b.min_lat, cut, cut_low, b.max_lon);
+                cells[2] = GeoBounds(cut, b.max_lat, b.min_lon, cut_high);
+                cells[3] = GeoBounds(cut, b.max_lat, cut_high, b.max_lon);
+            } else {
+                cells[0] = GeoBounds(b.min_lat, cut_low, b.min_lon, cut);
+                cells[1] = GeoBounds(cut_low, b.max_lat, b.min_lon, cut);
+                cells[2] = GeoBounds(b.min_lat, cut_high, cut, b.max_lon);
+                cells[3] = GeoBounds(cut_high, b.max_lat, cut, b.max_lon);
+            }
+            return;
+        }
+        }
+        
+        cells[0] = GeoBounds(b.min_lat, mid_lat, b.min_lon, mid_lon); // SW
+        cells[1] = GeoBounds(b.min_lat, mid_lat, mid_lon, b.max_lon);  // SE
+        cells[2] = GeoBounds(mid_lat, b.max_lat, b.min_lon, mid_lon);  // NW
+        cells[3] = GeoBounds(mid_lat, b.max_lat, mid_lon, b.max_lon);  // NE
+    }
+    
+private:
+    // rank-th smallest of values (reordered), clamped into [lo, hi] so cuts
+    // stay inside the cell when stations outside the root bounds are present
+    template <typename Value>
+    static double orderStatistic(Value* values, size_t count, size_t rank, double lo, double hi) {
+        nth_element(values, values + rank, values + count);
+        return min(max(static_cast<double>(values[rank]), lo), hi);
+    }
+    
+public:
+    
+    // Simple triangulation for base case
+    EpicenterResult simpleTriangulation(Span<const SeismicStation> stations) const {
+        if (stations.empty()) {
+            return EpicenterResult(Point(0, 0), 0, 1e9);
+        }
+        
+        if (stations.size() == 1) {
+            return EpicenterResult(Point(stations[0].latitude, stations[0].longitude), 1.0, 0);
+        }
+        
+        // Use geometric approach: intersection of circles
+        // For simplicity, use least squares method
+        double sum_x = 0, sum_y = 0;
+        double min_time = stations[0].detection_time;
+        
+        // Find minimum detection time (closest to epicenter)
+        for (const auto& station : stations) {
+            min_time = min(min_time, station.detection_time);
+        }
+        
+        // Calculate weighted center based on time differences
+        double total_weight = 0;
+        for (const auto& station : stations) {
+            double time_diff = station.detection_time - min_time;
+            double weight = 1.0 / (1.0 + time_diff * time_diff); // Inverse time weighting
+            
+            sum_x += station.latitude * weight;
+            sum_y += station.longitude * weight;
+            total_weight += weight;
+        }
+        
+        Point estimated_center(sum_x / total_weight, sum_y / total_weight);
+        
+        // Calculate error (sum of squared residuals)
+        double error = 0;
+        for (const auto& station : stations) {
+            double theoretical_time;
+            if (config.travel_times) {
+                theoretical_time = config.travel_times->travelTime(estimated_center.x - station.latitude,
+                                                                   estimated_center.y - station.longitude);
+            } else {
+                double distance = estimated_center.distance(Point(station.latitude, station.longitude));
+                theoretical_time = distance / WAVE_VELOCITY;
+            }
+            double actual_time = station.detection_time - min_time;
+            error += (theoretical_time - actual_time) * (theoretical_time - actual_time);
+        }
+        
+        double confidence = 1.0 / (1.0 + error / stations.size());
+        return EpicenterResult(estimated_center, confidence, error);
+    }
+    
+    // Same model over SoA storage using the dispatched SIMD kernels
+    EpicenterResult simpleTriangulation(const StationSetView& stations) const {
+        if (stations.empty()) {
+            return EpicenterResult(Point(0, 0), 0, 1e9);
+        }
+        return simpleTriangulation(stations, kernels().minTime(stations.detection_time, stations.size()));
+    }
+    
+    // Fused variant for callers that already know the range's earliest
+    // detection (the partition pass computes it for free). The weights depend
+    // on min_time and the residuals on the weighted center, so two passes
+    // remain: centroid, then residuals.
+    EpicenterResult simpleTriangulation(const StationSetView& stations, double min_time) const {
+        if (stations.empty()) {
+            return EpicenterResult(Point(0, 0), 0, 1e9);
+        }
+        
+        if (config.fixed_size_leaves && stations.size() <= kernels().fixed_leaf_limit && !config.travel_times) {
+            return FIXED_LEAF_SOLVERS[stations.size()](stations.latitude, stations.longitude,
+                                                       stations.detection_time, min_time, WAVE_VELOCITY);
+        }
+        
+        if (stations.size() == 1) {
+            return EpicenterResult(Point(stations.latitude[0], stations.longitude[0]), 1.0, 0);
+        }
+        
+        const TriangulationKernels& k = kernels();
+        double sums[3];
+        k.weightedCentroid(stations.latitude, stations.longitude, stations.detection_time,
+                           stations.size(), min_time, sums);
+        
+        Point estimated_center(sums[0] / sums[2], sums[1] / sums[2]);
+        
+        double error = config.travel_times
+            ? k.residualErrorTable(stations.latitude, stations.longitude, stations.detection_time,
+                                   stations.size(), estimated_center.x, estimated_center.y,
+                                   min_time, *config.travel_times)
+            : k.residualError(stations.latitude, stations.longitude, stations.detection_time,
+                              stations.size(), estimated_center.x, estimated_center.y,
+                              min_time, WAVE_VELOCITY);
+        
+        double confidence = 1.0 / (1.0 + error / stations.size());
+        return EpicenterResult(estimated_center, confidence, error);
+    }
+    
+    // Float32 storage: the float kernels of the configured instruction set,
+    // with travel-time tables evaluated by a scalar loop
+    EpicenterResult simpleTriangulation(const FloatStationSetView& stations) const {
+        if (stations.empty()) {
+            return EpicenterResult(Point(0, 0), 0, 1e9);
+        }
+        return simpleTriangulation(stations, floatKernels().minTime(stations.detection_time, stations.size()));
+    }
+    
+    EpicenterResult simpleTriangulation(const FloatStationSetView& stations, double min_time) const {
+        if (stations.empty()) {
+            return EpicenterResult(Point(0, 0), 0, 1e9);
+        }
+        if (stations.size() == 1) {
+            return EpicenterResult(Point(stations.latitude[0], stations.longitude[0]), 1.0, 0);
+        }
+        
+        const FloatTriangulationKernels& k = floatKernels();
+        double sums[3];
+        k.weightedCentroid(stations.latitude, stations.longitude, stations.detection_time,
+                           stations.size(), min_time, sums);
+        
+        Point estimated_center(sums[0] / sums[2], sums[1] / sums[2]);
+        
+        double error = 0;
+        if (config.travel_times) {
+            for (size_t i = 0; i < stations.size(); i++) {
+                double theoretical_time = config.travel_times->travelTime(
+                    estimated_center.x - stations.latitude[i], estimated_center.y - stations.longitude[i]);
+                double actual_time = stations.detection_time[i] - min_time;
+                error += (theoretical_time - actual_time) * (theoretical_time - actual_time);
+            }
+        } else {
+            error = k.residualError(stations.latitude, stations.longitude, stations.detection_time,
+                                    stations.size(), estimated_center.x, estimated_center.y,
+                                    min_time, WAVE_VELOCITY);
+        }
+        
+        double confidence = 1.0 / (1.0 + error / stations.size());
+        return EpicenterResult(estimated_center, confidence, error);
+    }
+    
+    // Leaf statistics for CombineMode::summary: simpleTriangulation's
+    // centroid kernels for the weighted sums, then the second moments in
+    // station order. The summary's residual comes from the moments, so
+    // travel_times does not enter it.
+    template <typename Real>
+    EpicenterSummary summarize(const BasicStationSetView<Real>& stations) const {
+        if (stations.empty()) {
+            return EpicenterSummary();
+        }
+        return summarize(stations, minDetection(stations.detection_time, stations.size()));
+    }
+    
+    EpicenterSummary summarize(const StationSetView& stations, double min_time) const {
+        EpicenterSummary summary;
+        if (stations.empty()) {
+            return summary;
+        }
+        double sums[3];
+        kernels().weightedCentroid(stations.latitude, stations.longitude, stations.detection_time,
+                                   stations.size(), min_time, sums);
+        summarizeSums(summary, sums, stations, min_time);
+        return summary;
+    }
+    
+    EpicenterSummary summarize(const FloatStationSetView& stations, double min_time) const {
+        EpicenterSummary summary;
+        if (stations.empty()) {
+            return summary;
+        }
+        double sums[3];
+        floatKernels().weightedCentroid(stations.latitude, stations.longitude, stations.detection_time,
+                                        stations.size(), min_time, sums);
+        summarizeSums(summary, sums, stations, min_time);
+        return summary;
+    }
+    
+    // Weighted combination of multiple estimates
+    EpicenterResult weightedCombination(Span<const EpicenterResult> results) const {
+        if (results.empty()) {
+            return EpicenterResult(Point(0, 0), 0, 1e9);
+        }
+        
+        if (results.size() == 1) {
+            return results[0];
+        }
+        
+        double total_weight = 0;
+        double weighted_x = 0, weighted_y = 0;
+        double combined_error = 0;
+        
+        for (const auto& result : results) {
+            double weight = result.confidence;
+            weighted_x += result.location.x * weight;
+            weighted_y += result.location.y * weight;
+            total_weight += weight;
+            combined_error += result.error * weight;
+        }
+        
+        Point combined_location(weighted_x / total_weight, weighted_y / total_weight);
+        double combined_confidence = total_weight / results.size();
+        
+        return EpicenterResult(combined_location, combined_confidence, combined_error / total_weight);
+    }
+    
+    // Coarse-to-fine grid search over bounds (LocateEngine::grid_search, see
+    // LocatorConfig). A candidate's misfit is the sum of squared travel-time
+    // residuals of the stations at the origin time that minimizes it, under
+    // the straight-ray model or config.travel_times. The result's error is
+    // that misfit, and its confidence follows simpleTriangulation's formula.
+    // With fewer stations than unknowns (location and origin time), or all
+    // of them within one grid_resolution cell, the misfit is flat and the
+    // leaf solve of simpleTriangulation is returned instead.
+    EpicenterResult gridSearch(const StationSetView& stations, const GeoBounds& bounds,
+                               GridSearchReport* report = nullptr) const {
+        GridSearchReport outcome;
+        size_t n = stations.size();
+        if (n == 0) {
+            if (report) {
+                *report = outcome;
+            }
+            return EpicenterResult(Point(0, 0), 0, 1e9);
+        }
+        double min_time = kernels().minTime(stations.detection_time, n);
+        if (n < 3 || withinOneCell(stations, config.grid_resolution)) {
+            if (report) {
+                *report = outcome;
+            }
+            return simpleTriangulation(stations, min_time);
+        }
+        
+        // Level depth scores an evenly strided sample of grid_sample << depth
+        // stations; samples are nested, and the full set is used from the
+        // level where the sample would reach it
+        StationSet sample;
+        auto levelStations = [&](int depth) {
+            size_t m = config.grid_sample == 0 || depth >= 48 ? n : config.grid_sample << depth;
+            if (m >= n) {
+                return stations;
+            }
+            sample.resize(m);
+            for (size_t j = 0; j < m; j++) {
+                size_t i = j * n / m;
+                sample.latitude[j] = stations.latitude[i];
+                sample.longitude[j] = stations.longitude[i];
+                sample.detection_time[j] = stations.detection_time[i];
+                sample.id[j] = stations.id[i];
+            }
+            return sample.view();
+        };
+        
+        struct Candidate {
+            GeoBounds cell;
+            double misfit;
+        };
+        auto score = [&](const StationSetView& set, const GeoBounds& cell) {
+            outcome.candidates++;
+            outcome.evaluations += set.size();
+            return gridMisfit(set, min_time, cell.center());
+        };
+        // Midpoint splits keep every cell of a level the same size
+        auto coarser = [this](const GeoBounds& cell) {
+            return max(cell.max_lat - cell.min_lat, cell.max_lon - cell.min_lon) >= config.grid_resolution;
+        };
+        
+        size_t beam = static_cast<size_t>(max(config.grid_beam, 1));
+        vector<Candidate> cells(1, Candidate{bounds, 0.0}), children;
+        bool sampled = true;
+        for (int depth = 0; depth < config.max_depth && coarser(cells[0].cell); depth++) {
+            StationSetView coarse = levelStations(depth);
+            sampled = coarse.size() != n;
+            children.clear();
+            for (const Candidate& parent : cells) {
+                GeoBounds quadrants[4];
+                splitCell(parent.cell, depth, 0, [](size_t) { return 0.0; }, [](size_t) { return 0.0; },
+                          static_cast<double*>(nullptr), static_cast<double*>(nullptr), quadrants);
+                for (const GeoBounds& quadrant : quadrants) {
+                    children.push_back(Candidate{quadrant, score(coarse, quadrant)});
+                }
+            }
+            size_t keep = min(beam, children.size());
+            partial_sort(children.begin(), children.begin() + keep, children.end(),
+                         [](const Candidate& a, const Candidate& b) { return a.misfit < b.misfit; });
+            children.resize(keep);
+            cells.swap(children);
+            outcome.levels++;
+        }
+        
+        // The surviving cells against every station
+        if (sampled) {
+            for (Candidate& candidate : cells) {
+                candidate.misfit = score(stations, candidate.cell);
+            }
+        }
+        const Candidate& best = *min_element(cells.begin(), cells.end(),
+            [](const Candidate& a, const Candidate& b) { return a.misfit < b.misfit; });
+        
+        if (report) {
+            *report = outcome;
+        }
+        return EpicenterResult(best.cell.center(), 1.0 / (1.0 + best.misfit / n), best.misfit);
+    }
+    
+    // Gauss-Newton refinement of an estimate (Geiger's method). Each
+    // iteration fits the travel-time residuals of all stations against
+    // location and origin time in one kernel pass and solves the 3x3 normal
+    // equations; a step that raises the squared residuals is halved. The
+    // starting origin time is the mean residual at the initial location.
+    // The result's error is the sum of squared residuals at the fitted
+    // origin time, and its confidence follows simpleTriangulation's formula.
+    EpicenterResult refineEpicenter(const StationSetView& stations, const EpicenterResult& initial,
+                                    RefineReport* report = nullptr) const {
+        RefineReport outcome;
+        size_t n = stations.size();
+        if (n < 3) {  // Three unknowns
+            if (report) {
+                *report = outcome;
+            }
+            return initial;
+        }
+        
+        const TriangulationKernels& k = kernels();
+        auto evaluate = [&](double x, double y, double t0, double* sums) {
+            k.normalEquations(stations.latitude, stations.longitude, stations.detection_time, n,
+                              x, y, t0, WAVE_VELOCITY, sums);
+        };
+        
+        double x = initial.location.x, y = initial.location.y;
+        double sums[9];
+        evaluate(x, y, 0.0, sums);
+        double t0 = sums[7] / n;
+        evaluate(x, y, t0, sums);
+        outcome.initial_error = sums[8];
+        
+        const int MAX_HALVINGS = 8;
+        while (outcome.iterations < config.refine_max_iterations) {
+            double normal[6] = {sums[0], sums[1], sums[2], sums[3], sums[4], static_cast<double>(n)};
+            double gradient[3] = {sums[5], sums[6], sums[7]};
+            double step[3];
+            if (!solveNormal3(normal, gradient, step)) {
+                break;  // Stations collinear with the estimate
+            }
+            
+            double trial[9];
+            double scale = 1.0;
+            bool accepted = false;
+            for (int h = 0; h <= MAX_HALVINGS; h++) {
+                evaluate(x + scale * step[0], y + scale * step[1], t0 + scale * step[2], trial);
+                if (trial[8] <= sums[8]) {
+                    accepted = true;
+                    break;
+                }
+                scale *= 0.5;
+            }
+            if (!accepted) {
+                outcome.converged = true;  // No descent left along the Gauss-Newton direction
+                break;
+            }
+            x += scale * step[0];
+            y += scale * step[1];
+            t0 += scale * step[2];
+            copy(trial, trial + 9, sums);
+            outcome.iterations++;
+            
+            if (scale * sqrt(step[0] * step[0] + step[1] * step[1]) < config.refine_tolerance) {
+                outcome.converged = true;
+                break;
+            }
+        }
+        
+        outcome.origin_time = t0;
+        if (report) {
+            *report = outcome;
+        }
+        double error = sums[8];
+        return EpicenterResult(Point(x, y), 1.0 / (1.0 + error / n), error);
+    }
+    
+private:
+    // True if the stations' bounding box is no wider than resolution degrees
+    // on either axis, so no grid level can tell their cells apart
+    static bool withinOneCell(const StationSetView& stations, double resolution) {
+        double min_lat = stations.latitude[0], max_lat = min_lat;
+        double min_lon = stations.longitude[0], max_lon = min_lon;
+        for (size_t i = 1; i < stations.size(); i++) {
+            min_lat = min(min_lat, stations.latitude[i]);
+            max_lat = max(max_lat, stations.latitude[i]);
+            min_lon = min(min_lon, stations.longitude[i]);
+            max_lon = max(max_lon, stations.longitude[i]);
+        }
+        return max_lat - min_lat <= resolution && max_lon - min_lon <= resolution;
+    }
+    
+    // Grid search misfit at p: the squared residuals about their mean, which
+    // is their sum at the best-fitting origin time. Times are taken relative
+    // to min_time to keep the sums small.
+    double gridMisfit(const StationSetView& stations, double min_time, Point p) const {
+        const TriangulationKernels& k = kernels();
+        size_t n = stations.size();
+        if (config.travel_times) {
+            // The table kernel gives E(a) = sum (T - t + a)^2; two offsets
+            // recover the linear term sum (T - t + min_time)
+            double e0 = k.residualErrorTable(stations.latitude, stations.longitude, stations.detection_time,
+                                             n, p.x, p.y, min_time, *config.travel_times);
+            double e1 = k.residualErrorTable(stations.latitude, stations.longitude, stations.detection_time,
+                                             n, p.x, p.y, min_time + 1, *config.travel_times);
+            double sum = (e1 - e0 - n) / 2;
+            return max(e0 - sum * sum / n, 0.0);
+        }
+        double sums[9];
+        k.normalEquations(stations.latitude, stations.longitude, stations.detection_time, n,
+                          p.x, p.y, min_time, WAVE_VELOCITY, sums);
+        return max(sums[8] - sums[7] * sums[7] / n, 0.0);
+    }
+    
+    // Fills a one-leaf summary from a weightedCentroid result, adding the
+    // second moments with the same inverse-time weights
+    template <typename Real>
+    static void summarizeSums(EpicenterSummary& summary, const double* sums, 
+                              const BasicStationSetView<Real>& stations, double min_time) {
+        summary.count = stations.size();
+        summary.leaves = 1;
+        summary.min_arrival = min_time;
+        summary.weight = sums[2];
+        summary.weighted_lat = sums[0];
+        summary.weighted_lon = sums[1];
+        for (size_t i = 0; i < stations.size(); i++) {
+            double time = static_cast<double>(stations.detection_time[i]) - min_time;
+            summary.addMoments(stations.latitude[i], stations.longitude[i], time, 1.0 / (1.0 + time * time));
+        }
+    }
+    
+    // Solves the symmetric 3x3 system a * x = b by Cholesky factorisation;
+    // a holds the upper triangle row by row {a00, a01, a02, a11, a12, a22}.
+    // Returns false when a is not positive definite.
+    static bool solveNormal3(const double* a, const double* b, double* x) {
+        double l00 = a[0];
+        if (!(l00 > 0)) {
+            return false;
+        }
+        l00 = sqrt(l00);
+        double l10 = a[1] / l00;
+        double l20 = a[2] / l00;
+        double l11 = a[3] - l10 * l10;
+        if (!(l11 > 1e-12 * a[3])) {
+            return false;
+        }
+        l11 = sqrt(l11);
+        double l21 = (a[4] - l20 * l10) / l11;
+        double l22 = a[5] - l20 * l20 - l21 * l21;
+        if (!(l22 > 1e-12 * a[5])) {
+            return false;
+        }
+        l22 = sqrt(l22);
+        
+        double z0 = b[0] / l00;
+        double z1 = (b[1] - l10 * z0) / l11;
+        double z2 = (b[2] - l20 * z0 - l21 * z1) / l22;
+        x[2] = z2 / l22;
+        x[1] = (z1 - l21 * x[2]) / l11;
+        x[0] = (z0 - l10 * x[1] - l20 * x[2]) / l00;
+        return true;
+    }
+    
+public:
+    // Generate synthetic earthquake data
+    static vector<SeismicStation> generateEarthquakeData(int num_stations, 
+                                                        Point true_epicenter,
+                                                        const GeoBounds& region) {
+        vector<SeismicStation> stations;
+        stations.reserve(max(num_stations, 0));
+        random_device rd;
+        mt19937 gen(rd());
+        uniform_real_distribution<> lat_dist(region.min_lat, region.max_lat);
+        uniform_real_distribution<> lon_dist(region.min_lon, region.max_lon);
+        uniform_real_distribution<> noise_dist(-0.5, 0.5); // Time noise
+        
+        for (int i = 0; i < num_stations; i++) {
+            double lat = lat_dist(gen);
+            double lon = lon_dist(gen);
+            
+            // Calculate theoretical arrival time
+            double distance = true_epicenter.distance(Point(lat, lon));
+            double travel_time = distance / WAVE_VELOCITY;
+            double detected_time = travel_time + noise_dist(gen); // Add noise
+            
+            stations.emplace_back(i, lat, lon, detected_time);
+        }
+        
+        return stations;
+    }
+    
+    // Performance testing
+    // Wall time of one locate in milliseconds; the estimate goes to result
+    static double measureExecutionTime(BasicEpicenterLocator& locator,
+                                      vector<SeismicStation>& stations,
+                                      const GeoBounds& bounds,
+                                      EpicenterResult* result = nullptr) {
+        auto start = steady_clock::now();
+        EpicenterResult located = locator.locateEpicenter(stations, bounds);
+        auto end = steady_clock::now();
+        
+        if (result) {
+            *result = located;
+        }
+        return duration<double, milli>(end - start).count();
+    }
+    
+    // Complexity analysis: mean time per size for the plotting script.
+    // earthquake_benchmark.cpp has the per-phase benchmarks with percentiles.
+    static void runComplexityAnalysis() {
+        cout << "\n=== DIVIDE & CONQUER COMPLEXITY ANALYSIS ===\n";
+        cout << "Testing earthquake epicenter location with varying station counts...\n";
+        cout << "Format: Stations, Time(ms), Error, Estimated_Location\n\n";
+        
+        ofstream file("earthquake_results.csv");
+        CsvWriter csv(file);
+        csv.field("Stations").field("Time_ms").field("Error").field("Location_X").field("Location_Y");
+        csv.endRow();
+        
+        vector<int> test_sizes = {25, 50, 100, 200, 500, 1000, 1500, 2000};
+        Point true_epicenter(35.0, -120.0); // California coordinates
+        GeoBounds california(32.0, 42.0, -125.0, -114.0); // California region
+        
+        for (int n : test_sizes) {
+            double total_time = 0.0;
+            double total_error = 0.0;
+            Point avg_location(0, 0);
+            int trials = 5;
+            
+            for (int trial = 0; trial < trials; trial++) {
+                BasicEpicenterLocator locator;
+                vector<SeismicStation> stations = generateEarthquakeData(n, true_epicenter, california);
+                
+                EpicenterResult result;
+                double exec_time = measureExecutionTime(locator, stations, california, &result);
+                
+                total_time += exec_time;
+                total_error += result.error;
+                avg_location.x += result.location.x;
+                avg_location.y += result.location.y;
+            }
+            
+            double avg_time = total_time / trials;
+            double avg_error = total_error / trials;
+            avg_location.x /= trials;
+            avg_location.y /= trials;
+            
+            double location_error = true_epicenter.distance(avg_location);
+            
+            cout << setw(8) << n 
+                 << setw(12) << fixed << setprecision(3) << avg_time
+                 << setw(12) << fixed << setprecision(6) << avg_error
+                 << setw(12) << fixed << setprecision(3) << location_error << " km"
+                 << " (" << fixed << setprecision(3) << avg_location.x 
+                 << ", " << avg_location.y << ")" << endl;
+            
+            csv.field(n).field(avg_time).field(avg_error).field(avg_location.x).field(avg_location.y);
+            csv.endRow();
+        }
+        
+        csv.flush();
+        file.close();
+        cout << "\nResults saved to earthquake_results.csv\n";
+        cout << "True epicenter: (" << true_epicenter.x << ", " << true_epicenter.y << ")\n";
+    }
+};
+
+typedef BasicEpicenterLocator<> EarthquakeEpicenterLocator;
+
+// Quadtree over station positions that persists across events.
+// It is built once from the network geometry with the same midpoint splits
+// and base case as locateEpicenter; each event only attaches arrival times
+// and re-runs the leaf solves and the combine. Stations can join and leave
+// in O(log n) without a rebuild: a leaf splits when it outgrows the base
+// case and a subtree collapses back into a leaf when it shrinks to it.
+class StationQuadtree {
+    friend class StationNetwork;
+    
+public:
+    struct Node {
+        GeoBounds bounds;
+        int parent;
+        int children[4];          // -1 for a leaf
+        int depth;
+        size_t count;             // Stations in the subtree
+        vector<int> stations;     // Station slots, leaves only
+        
+        Node(const GeoBounds& b, int _parent, int _depth) 
+            : bounds(b), parent(_parent), depth(_depth), count(0) {
+            fill(children, children + 4, -1);
+        }
+        
+        bool isLeaf() const { return children[0] < 0; }
+    };
+    
+private:
+    EarthquakeEpicenterLocator locator;   // Leaf solver and combine
+    vector<Node> nodes;                   // nodes[0] is the root
+    vector<int> free_nodes;
+    
+    // Station geometry by slot; slots of removed stations are reused
+    vector<double> latitude;
+    vector<double> longitude;
+    vector<int> station_id;
+    vector<int> leaf_of_slot;
+    vector<int> free_slots;
+    vector<int> slot_of_id;               // -1 = not in the network
+    size_t num_stations;
+    
+    StationSet leaf_buffer;               // Gathered stations of one leaf
+    
+public:
+    StationQuadtree(const GeoBounds& root_bounds, const LocatorConfig& config = LocatorConfig())
+        : locator(config), num_stations(0) {
+        nodes.push_back(Node(root_bounds, -1, 0));
+    }
+    
+    // Build from network geometry; detection times are ignored. All stations
+    // are placed before the first split, so station-driven split strategies
+    // see the whole network and give the same cells as locateEpicenter.
+    StationQuadtree(Span<const SeismicStation> stations, const GeoBounds& root_bounds,
+                    const LocatorConfig& config = LocatorConfig())
+        : StationQuadtree(root_bounds, config) {
+        for (const auto& station : stations) {
+            attach(station);
+        }
+        splitSubtree(0);
+    }
+    
+    size_t size() const { return num_stations; }
+    const GeoBounds& bounds() const { return nodes[0].bounds; }
+    const vector<Node>& getNodes() const { return nodes; }
+    
+    bool contains(int id) const {
+        return id >= 0 && id < static_cast<int>(slot_of_id.size()) && slot_of_id[id] >= 0;
+    }
+    
+    // Adds a station; returns false if it lies outside the root bounds or
+    // its id is negative or already present
+    // A leaf that outgrows the base case is split using the stations it
+    // holds at that moment, so with a station-driven split strategy the
+    // cells of an incrementally grown tree can differ from a fresh build.
+    bool insert(const SeismicStation& station) {
+        int leaf = attach(station);
+        if (leaf < 0) {
+            return false;
+        }
+        splitIfNeeded(leaf);
+        return true;
+    }
+    
+    // Removes a station; returns false if it is not in the network
+    bool remove(int id) {
+        if (!contains(id)) {
+            return false;
+        }
+        
+        int slot = slot_of_id[id];
+        int leaf = leaf_of_slot[slot];
+        vector<int>& members = nodes[leaf].stations;
+        members.erase(find(members.begin(), members.end(), slot));
+        
+        // Find the highest ancestor that no longer needs to be split
+        int collapse = -1;
+        for (int node = leaf; node >= 0; node = nodes[node].parent) {
+            nodes[node].count--;
+            if (!nodes[node].isLeaf() && 
+                locator.isLeafCell(nodes[node].count, nodes[node].bounds, nodes[node].depth)) {
+                collapse = node;
+            }
+        }
+        if (collapse >= 0) {
+            collapseInto(collapse);
+        }
+        
+        slot_of_id[id] = -1;
+        leaf_of_slot[slot] = -1;
+        free_slots.push_back(slot);
+        num_stations--;
+        return true;
+    }
+    
+    // Locate one event. Stations without a pick (NaN, or id past the end of
+    // arrival_times) are left out of their leaf's solve.
+    EpicenterResult locate(const ArrivalVector& arrival_times) {
+        if (locator.getConfig().combine_mode == CombineMode::summary) {
+            return summarize(arrival_times).result();
+        }
+        return locateNode(0, arrival_times);
+    }
+    
+    // Summary of one event over the whole tree (CombineMode::summary)
+    EpicenterSummary summarize(const ArrivalVector& arrival_times) {
+        return summarizeNode(0, arrival_times);
+    }
+    
+private:
+    // Stores the station and appends it to its leaf without splitting;
+    // returns the leaf, or -1 if the station was rejected
+    int attach(const SeismicStation& station) {
+        if (station.id < 0 || contains(station.id) || !bounds().contains(station)) {
+            return -1;
+        }
+        
+        int slot = allocateSlot();
+        latitude[slot] = station.latitude;
+        longitude[slot] = station.longitude;
+        station_id[slot] = station.id;
+        if (station.id >= static_cast<int>(slot_of_id.size())) {
+            slot_of_id.resize(station.id + 1, -1);
+        }
+        slot_of_id[station.id] = slot;
+        num_stations++;
+        
+        int node = 0;
+        while (true) {
+            nodes[node].count++;
+            if (nodes[node].isLeaf()) {
+                break;
+            }
+            node = nodes[node].children[childIndex(node, slot)];
+        }
+        
+        nodes[node].stations.push_back(slot);
+        leaf_of_slot[slot] = node;
+        return node;
+    }
+    
+    int allocateSlot() {
+        if (!free_slots.empty()) {
+            int slot = free_slots.back();
+            free_slots.pop_back();
+            return slot;
+        }
+        latitude.push_back(0);
+        longitude.push_back(0);
+        station_id.push_back(-1);
+        leaf_of_slot.push_back(-1);
+        return static_cast<int>(station_id.size()) - 1;
+    }
+    
+    int allocateNode(const GeoBounds& b, int parent, int depth) {
+        if (!free_nodes.empty()) {
+            int index = free_nodes.back();
+            free_nodes.pop_back();
+            nodes[index] = Node(b, parent, depth);
+            return index;
+        }
+        nodes.push_back(Node(b, parent, depth));
+        return static_cast<int>(nodes.size()) - 1;
+    }
+    
+    // Same first-match rule as locateEpicenter's partition
+    int childIndex(int node, int slot) const {
+        for (int q = 0; q < 4; q++) {
+            if (nodes[nodes[node].children[q]].bounds.contains(latitude[slot], longitude[slot])) {
+                return q;
+            }
+        }
+        return 3;  // Unreachable for stations inside the parent's bounds
+    }
+    
+    // Splits an overfull leaf until every new leaf is a leaf cell
+    void splitIfNeeded(int node) {
+        while (!locator.isLeafCell(nodes[node].count, nodes[node].bounds, nodes[node].depth)) {
+            splitNode(node);
+            int overfull = -1;
+            for (int q = 0; q < 4; q++) {
+                const Node& child = nodes[nodes[node].children[q]];
+                if (!locator.isLeafCell(child.count, child.bounds, child.depth)) {
+                    overfull = nodes[node].children[q];
+                }
+            }
+            if (overfull < 0) {
+                return;
+            }
+            node = overfull;  // All but one child are within the base case
+        }
+    }
+    
+    // Splits every overfull leaf of a subtree, top-down
+    void splitSubtree(int node) {
+        if (locator.isLeafCell(nodes[node].count, nodes[node].bounds, nodes[node].depth)) {
+            return;
+        }
+        splitNode(node);
+        for (int q = 0; q < 4; q++) {
+            splitSubtree(nodes[node].children[q]);
+        }
+    }
+    
+    // Turns a leaf into four leaf children holding its stations
+    void splitNode(int node) {
+        vector<int> members;
+        members.swap(nodes[node].stations);
+        
+        GeoBounds cells[4];
+        {
+            size_t n = members.size();
+            vector<double> buffer(locator.splitUsesStations() ? 2 * n : 0);
+            locator.splitCell(nodes[node].bounds, nodes[node].depth, n,
+                              [&](size_t i) { return latitude[members[i]]; },
+                              [&](size_t i) { return longitude[members[i]]; },
+                              buffer.data(), buffer.data() + n, cells);
+        }
+        int depth = nodes[node].depth + 1;
+        for (int q = 0; q < 4; q++) {
+            int child = allocateNode(cells[q], node, depth);
+            nodes[node].children[q] = child;
+        }
+        
+        // Redistribute in order so each leaf keeps insertion order
+        for (int slot : members) {
+            int child = nodes[node].children[childIndex(node, slot)];
+            nodes[child].stations.push_back(slot);
+            nodes[child].count++;
+            leaf_of_slot[slot] = child;
+        }
+    }
+    
+    void collapseInto(int node) {
+        vector<int> members;
+        gatherSlots(node, members);
+        // Slots are handed out in insertion order, which keeps a collapsed
+        // leaf in the same order a rebuild would give it
+        sort(members.begin(), members.end());
+        nodes[node].stations = members;
+        fill(nodes[node].children, nodes[node].children + 4, -1);
+        for (int slot : members) {
+            leaf_of_slot[slot] = node;
+        }
+    }
+    
+    // Collects the subtree's slots and frees its descendant nodes
+    void gatherSlots(int node, vector<int>& members) {
+        if (nodes[node].isLeaf()) {
+            members.insert(members.end(), nodes[node].stations.begin(), nodes[node].stations.end());
+            return;
+        }
+        for (int q = 0; q < 4; q++) {
+            int child = nodes[node].children[q];
+            gatherSlots(child, members);
+            nodes[child].stations.clear();
+            free_nodes.push_back(child);
+        }
+    }
+    
+    EpicenterResult locateNode(int node, const ArrivalVector& arrival_times) {
+        const Node& current = nodes[node];
+        if (current.isLeaf()) {
+            return solveLeaf(node, arrival_times, leaf_buffer, locator);
+        }
+        
+        EpicenterResult results[4];
+        for (int q = 0; q < 4; q++) {
+            int child = current.children[q];
+            if (nodes[child].count > 0) {
+                results[q] = locateNode(child, arrival_times);
+            }
+        }
+        return combineChildren(node, results, locator);
+    }
+    
+    EpicenterSummary summarizeNode(int node, const ArrivalVector& arrival_times) {
+        const Node& current = nodes[node];
+        if (current.isLeaf()) {
+            return summarizeLeaf(node, arrival_times, leaf_buffer, locator);
+        }
+        EpicenterSummary summary;
+        for (int q = 0; q < 4; q++) {
+            summary.merge(summarizeNode(current.children[q], arrival_times));
+        }
+        return summary;
+    }
+    
+    // Gathers the leaf's stations that have a pick into buffer; returns how many
+    size_t gatherPicks(int node, const ArrivalVector& arrival_times, StationSet& buffer) const {
+        const Node& leaf = nodes[node];
+        buffer.resize(leaf.stations.size());
+        size_t picked = 0;
+        for (int slot : leaf.stations) {
+            int id = station_id[slot];
+            if (static_cast<size_t>(id) < arrival_times.size() && !std::isnan(arrival_times[id])) {
+                buffer.latitude[picked] = latitude[slot];
+                buffer.longitude[picked] = longitude[slot];
+                buffer.detection_time[picked] = arrival_times[id];
+                buffer.id[picked] = id;
+                picked++;
+            }
+        }
+        return picked;
+    }
+    
+public:
+    // Solves one leaf over its stations that have a pick; buffer is scratch
+    EpicenterResult solveLeaf(int node, const ArrivalVector& arrival_times, StationSet& buffer,
+                              const EarthquakeEpicenterLocator& solver) const {
+        size_t picked = gatherPicks(node, arrival_times, buffer);
+        return solver.simpleTriangulation(buffer.view(0, picked));
+    }
+    
+    // Same for CombineMode::summary
+    EpicenterSummary summarizeLeaf(int node, const ArrivalVector& arrival_times, StationSet& buffer,
+                                   const EarthquakeEpicenterLocator& solver) const {
+        size_t picked = gatherPicks(node, arrival_times, buffer);
+        return solver.summarize(buffer.view(0, picked));
+    }
+    
+    // Combines per-quadrant child results (indexed like children), skipping
+    // empty quadrants and subtrees in which no station has a pick
+    EpicenterResult combineChildren(int node, const EpicenterResult* child_results,
+                                    const EarthquakeEpicenterLocator& solver) const {
+        EpicenterResult results[4];
+        size_t num_results = 0;
+        for (int q = 0; q < 4; q++) {
+            int child = nodes[node].children[q];
+            if (nodes[child].count > 0 && child_results[q].confidence > 0) {
+                results[num_results++] = child_results[q];
+            }
+        }
+        return solver.weightedCombination(Span<const EpicenterResult>(results, num_results));
+    }
+    
+    // Leaf holding the given station, or -1 if it is not in the network
+    int leafOf(int id) const {
+        return contains(id) ? leaf_of_slot[slot_of_id[id]] : -1;
+    }
+};
+
+// Progressive locator for early warning: arrivals are fed one at a time and
+// each one yields a refined estimate. Per arrival only the station's leaf is
+// re-solved (at most the base case size of stations) and the combine is
+// redone along its root path from the cached results of the siblings, so
+// the cost is O(log n). Once every pick is in, the estimate equals
+// StationQuadtree::locate on the same arrivals. The tree must not be
+// modified while an event is in progress.
+class StreamingLocator {
+private:
+    const StationQuadtree& tree;
+    EarthquakeEpicenterLocator locator;
+    ArrivalVector arrivals;                // By station id, NaN until picked
+    vector<EpicenterResult> node_results;  // Latest result per tree node
+    vector<EpicenterSummary> node_summaries;  // Same, CombineMode::summary
+    StationSet leaf_buffer;
+    size_t num_picks;
+    
+public:
+    StreamingLocator(const StationQuadtree& _tree, const LocatorConfig& config = LocatorConfig())
+        : tree(_tree), locator(config), num_picks(0) {
+        reset();
+    }
+    
+    // Start a new event
+    void reset() {
+        arrivals.clear();
+        node_results.assign(tree.getNodes().size(), EpicenterResult());
+        if (locator.getConfig().combine_mode == CombineMode::summary) {
+            node_summaries.assign(tree.getNodes().size(), EpicenterSummary());
+        }
+        num_picks = 0;
+    }
+    
+    // Records a pick (replacing an earlier one for the same station) and
+    // returns the refined estimate. Stations outside the network are ignored.
+    EpicenterResult onArrival(int station_id, double time) {
+        int node = tree.leafOf(station_id);
+        if (node < 0) {
+            return current();
+        }
+        
+        if (static_cast<size_t>(station_id) >= arrivals.size()) {
+            arrivals.resize(station_id + 1, numeric_limits<double>::quiet_NaN());
+        }
+        if (std::isnan(arrivals[station_id])) {
+            num_picks++;
+        }
+        arrivals[station_id] = time;
+        
+        const vector<StationQuadtree::Node>& nodes = tree.getNodes();
+        if (locator.getConfig().combine_mode == CombineMode::summary) {
+            // Each parent is the O(1) merge of its four children
+            node_summaries[node] = tree.summarizeLeaf(node, arrivals, leaf_buffer, locator);
+            for (node = nodes[node].parent; node >= 0; node = nodes[node].parent) {
+                EpicenterSummary summary;
+                for (int q = 0; q < 4; q++) {
+                    summary.merge(node_summaries[nodes[node].children[q]]);
+                }
+                node_summaries[node] = summary;
+            }
+            node_results[0] = node_summaries[0].result();
+            return current();
+        }
+        node_results[node] = tree.solveLeaf(node, arrivals, leaf_buffer, locator);
+        for (node = nodes[node].parent; node >= 0; node = nodes[node].parent) {
+            EpicenterResult child_results[4];
+            for (int q = 0; q < 4; q++) {
+                child_results[q] = node_results[nodes[node].children[q]];
+            }
+            node_results[node] = tree.combineChildren(node, child_results, locator);
+        }
+        return current();
+    }
+    
+    EpicenterResult current() const { return node_results[0]; }
+    
+    // Statistics of all picks so far; CombineMode::summary only
+    EpicenterSummary summary() const {
+        return node_summaries.empty() ? EpicenterSummary() : node_summaries[0];
+    }
+    size_t pickCount() const { return num_picks; }
+    const ArrivalVector& getArrivals() const { return arrivals; }
+};
+
+// Bounded LRU memo of quadtree node estimates for StationNetwork. A node's
+// key is the network's generation(), its index, the combine mode and a
+// 64-bit hash of the arrival times of its stations (leaves hash their
+// picks, internal nodes their children's hashes), so replaying an event,
+// or re-locating after a late pick, reuses every node whose arrivals did
+// not change: one new pick re-solves one root-to-leaf path. Every rebuild
+// or snapshot restore gets a new generation, so one cache can serve
+// several networks without returning another build's estimates; their
+// entries share the budget. A hash collision would return a stale entry;
+// at 64 bits that is negligible for QA replays but the cache is not meant
+// for adversarial input. Not thread-safe.
+class NodeResultCache {
+public:
+    struct Key {
+        uint64_t network;         // StationNetwork::generation()
+        uint32_t node;
+        uint32_t mode;            // CombineMode of the estimate
+        uint64_t hash;
+        
+        bool operator==(const Key& other) const {
+            return network == other.network && node == other.node && mode == other.mode && 
+                   hash == other.hash;
+        }
+    };
+    
+    // A node's estimate; only the field of the key's mode is meaningful
+    struct Entry {
+        EpicenterResult result;
+        EpicenterSummary summary;
+    };
+    
+    struct Stats {
+        size_t hits;
+        size_t misses;
+        size_t evictions;
+        size_t entries;
+        size_t bytes;             // Estimated, see ENTRY_BYTES
+    };
+    
+    // Estimated footprint of one entry: key and value, the list node and a
+    // hash bucket with its node
+    static constexpr size_t ENTRY_BYTES = sizeof(Key) + sizeof(Entry) + 6 * sizeof(void*);
+    
+private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t place = (key.network << 33) ^ (uint64_t(key.node) << 1 | key.mode);
+            return static_cast<size_t>(key.hash ^ place * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+    
+    typedef list<pair<Key, Entry>> Recency;   // Most recently used first
+    Recency recency;
+    unordered_map<Key, Recency::iterator, KeyHash> index;
+    size_t budget_bytes;
+    size_t hits, misses, evictions;
+    
+public:
+    explicit NodeResultCache(size_t _budget_bytes = 64 << 20) 
+        : budget_bytes(_budget_bytes), hits(0), misses(0), evictions(0) {}
+    
+    // Looks up a key, counting a hit or a miss; a hit becomes most recent
+    bool find(const Key& key, Entry& entry) {
+        auto found = index.find(key);
+        if (found == index.end()) {
+            misses++;
+            return false;
+        }
+        hits++;
+        recency.splice(recency.begin(), recency, found->second);
+        entry = found->second->second;
+        return true;
+    }
+    
+    // Inserts or replaces an entry, evicting least recently used ones to
+    // stay within the budget
+    void insert(const Key& key, const Entry& entry) {
+        auto found = index.find(key);
+        if (found != index.end()) {
+            found->second->second = entry;
+            recency.splice(recency.begin(), recency, found->second);
+            return;
+        }
+        if (budget_bytes < ENTRY_BYTES) {
+            return;
+        }
+        while ((index.size() + 1) * ENTRY_BYTES > budget_bytes) {
+            index.erase(recency.back().first);
+            recency.pop_back();
+            evictions++;
+        }
+        recency.emplace_front(key, entry);
+        index[key] = recency.begin();
+    }
+    
+    // Shrinking the budget evicts at once
+    void setBudget(size_t bytes) {
+        budget_bytes = bytes;
+        while (!recency.empty() && index.size() * ENTRY_BYTES > budget_bytes) {
+            index.erase(recency.back().first);
+            recency.pop_back();
+            evictions++;
+        }
+    }
+    
+    void clear() {
+        recency.clear();
+        index.clear();
+    }
+    
+    void resetStats() { hits = misses = evictions = 0; }
+    
+    Stats stats() const {
+        return Stats{hits, misses, evictions, index.size(), index.size() * ENTRY_BYTES};
+    }
+};
+
+// Immutable, flattened form of a StationQuadtree for read-mostly use.
+// Nodes are stored in preorder and stations in leaf order, so every node
+// covers one contiguous station range and children always follow their
+// parent (a reverse sweep over nodes visits children before parents).
+// Empty quadrants are dropped.
+class StationNetwork {
+    friend struct TileCodec;
+    friend class TileServer;
+    friend class NetworkSnapshot;
+    
+public:
+    struct Node {
+        GeoBounds bounds;
+        uint32_t first;           // Station range [first, first + count)
+        uint32_t count;
+        int32_t children[4];      // Node index per quadrant, -1 = none
+        int32_t depth;
+        bool leaf;
+        
+        Node(const GeoBounds& b) : bounds(b), first(0), count(0), depth(0), leaf(true) {
+            fill(children, children + 4, -1);
+        }
+    };
+    
+    // Events solved together by locateBlock; one SIMD-friendly row per station
+    static const size_t EVENT_BLOCK = 8;
+    
+private:
+    vector<Node> nodes;
+    AlignedVector<double> latitude;
+    AlignedVector<double> longitude;
+    AlignedVector<int> station_id;
+    size_t max_leaf_size;
+    uint64_t build_generation;    // New on every build or reload; copies share it
+    
+    // Empty network for TileCodec to read into
+    StationNetwork() : max_leaf_size(0), build_generation(nextGeneration()) {}
+    
+    static uint64_t nextGeneration() {
+        static atomic<uint64_t> last{0};
+        return last.fetch_add(1, memory_order_relaxed) + 1;
+    }
+
+    // True when the root sits at root_depth and every other node is the
+    // child of exactly one earlier node, one level below it. Checked on
+    // nodes read from outside the process before anything walks them by
+    // depth.
+    bool depthsFollowTree(int32_t root_depth) const {
+        vector<int64_t> expected(nodes.size(), -1);
+        expected[0] = root_depth;
+        for (size_t k = 0; k < nodes.size(); k++) {
+            if (expected[k] < 0 || nodes[k].depth != expected[k]) {
+                return false;
+            }
+            for (int q = 0; q < 4; q++) {
+                int32_t child = nodes[k].children[q];
+                if (child < 0) {
+                    continue;
+                }
+                if (static_cast<size_t>(child) <= k || static_cast<size_t>(child) >= nodes.size() ||
+                    expected[child] >= 0) {
+                    return false;
+                }
+                expected[child] = expected[k] + 1;
+            }
+        }
+        return true;
+    }
+
+public:
+    explicit StationNetwork(const StationQuadtree& tree) 
+        : max_leaf_size(0), build_generation(nextGeneration()) {
+        latitude.reserve(tree.size());
+        longitude.reserve(tree.size());
+        station_id.reserve(tree.size());
+        flatten(tree, 0);
+    }
+    
+    StationNetwork(Span<const SeismicStation> stations, const GeoBounds& root_bounds,
+                   const LocatorConfig& config = LocatorConfig())
+        : StationNetwork(StationQuadtree(stations, root_bounds, config)) {}
+    
+    size_t size() const { return station_id.size(); }
+    const GeoBounds& bounds() const { return nodes[0].bounds; }
+    Span<const Node> getNodes() const { return Span<const Node>(nodes); }
+    size_t maxLeafSize() const { return max_leaf_size; }
+    
+    // Identifies this build of the stations, never 0. A network rebuilt in
+    // place (NetworkSnapshot::open, a TileServer LOAD) gets a new one, so
+    // device images can be keyed by it instead of by address.
+    uint64_t generation() const { return build_generation; }
+    
+    // Stations in leaf order; detection_time is not part of the network
+    StationSetView stations() const {
+        return StationSetView(latitude.data(), longitude.data(), nullptr, station_id.data(), size());
+    }
+    
+    // Locates up to EVENT_BLOCK events at once: each leaf gathers a
+    // stations x events tile of arrival times and runs simpleTriangulation
+    // with the event index as the inner, vectorizable loop. Per event the
+    // arithmetic is the same as the scalar kernels, in the same order.
+    // With CombineMode::summary the nodes merge summaries instead.
+    template <typename Locator>
+    void locateBlock(const ArrivalVector* events, size_t width, EpicenterResult* out,
+                     const Locator& locator,
+                     pmr::memory_resource* memory = pmr::new_delete_resource()) const {
+        const size_t B = EVENT_BLOCK;
+        if (locator.getConfig().combine_mode == CombineMode::summary) {
+            EpicenterSummary summaries[B];
+            summarizeBlock(events, width, summaries, locator, memory);
+            for (size_t e = 0; e < width; e++) {
+                out[e] = summaries[e].result();
+            }
+            return;
+        }
+        
+        pmr::vector<EpicenterResult> node_results(nodes.size() * B, memory);
+        pmr::vector<double> tile(max(max_leaf_size, size_t(1)) * B, memory);
+        
+        for (size_t n = nodes.size(); n-- > 0;) {
+            const Node& node = nodes[n];
+            EpicenterResult* slot = &node_results[n * B];
+            if (node.leaf) {
+                EpicenterSummary leaf[B];
+                double error[B];
+                solveLeafBlock(node, events, width, locator.getConfig().travel_times, tile.data(), leaf, error);
+                for (size_t e = 0; e < width; e++) {
+                    slot[e] = leaf[e].leafResult(error[e]);
+                }
+                continue;
+            }
+            for (size_t e = 0; e < width; e++) {
+                EpicenterResult children[4];
+                size_t num_children = 0;
+                for (int q = 0; q < 4; q++) {
+                    int child = node.children[q];
+                    if (child >= 0 && node_results[child * B + e].confidence > 0) {
+                        children[num_children++] = node_results[child * B + e];
+                    }
+                }
+                slot[e] = locator.weightedCombination(Span<const EpicenterResult>(children, num_children));
+            }
+        }
+        copy(node_results.begin(), node_results.begin() + width, out);
+    }
+    
+    // Locates one event through a NodeResultCache: node hashes are built
+    // bottom-up in one pass over the arrivals, then the tree is resolved
+    // top-down, stopping at every cached node. Results equal locateBlock's.
+    template <typename Locator>
+    EpicenterResult locateCached(const ArrivalVector& arrivals, const Locator& locator,
+                                 NodeResultCache& cache) const {
+        vector<uint64_t> hashes(nodes.size());
+        for (size_t n = nodes.size(); n-- > 0;) {
+            const Node& node = nodes[n];
+            uint64_t hash = 0x243F6A8885A308D3ULL;
+            if (node.leaf) {
+                for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                    int id = station_id[i];
+                    double time = static_cast<size_t>(id) < arrivals.size() ? arrivals[id] : NAN;
+                    uint64_t bits = 0x7FF8000000000000ULL;  // One pattern for every missing pick
+                    if (!std::isnan(time)) {
+                        memcpy(&bits, &time, sizeof(bits));
+                    }
+                    hash = mixHash(hash ^ bits);
+                }
+            } else {
+                for (int q = 0; q < 4; q++) {
+                    hash = mixHash(hash ^ (node.children[q] < 0 ? uint64_t(q) : hashes[node.children[q]]));
+                }
+            }
+            hashes[n] = hash;
+        }
+        
+        vector<double> tile(max(max_leaf_size, size_t(1)) * EVENT_BLOCK);
+        NodeResultCache::Entry root = resolveCached(0, &arrivals, hashes, tile.data(), locator, cache);
+        return locator.getConfig().combine_mode == CombineMode::summary ? root.summary.result() : root.result;
+    }
+    
+    // Root summaries of up to EVENT_BLOCK events, from the same leaf tiles;
+    // each internal node merges its children in quadrant order
+    template <typename Locator>
+    void summarizeBlock(const ArrivalVector* events, size_t width, EpicenterSummary* out,
+                        const Locator& locator,
+                        pmr::memory_resource* memory = pmr::new_delete_resource()) const {
+        const size_t B = EVENT_BLOCK;
+        pmr::vector<EpicenterSummary> node_summaries(nodes.size() * B, memory);
+        pmr::vector<double> tile(max(max_leaf_size, size_t(1)) * B, memory);
+        
+        for (size_t n = nodes.size(); n-- > 0;) {
+            const Node& node = nodes[n];
+            EpicenterSummary* slot = &node_summaries[n * B];
+            if (node.leaf) {
+                solveLeafBlock(node, events, width, locator.getConfig().travel_times, tile.data(), slot);
+                continue;
+            }
+            for (int q = 0; q < 4; q++) {
+                int child = node.children[q];
+                for (size_t e = 0; child >= 0 && e < width; e++) {
+                    slot[e].merge(node_summaries[child * B + e]);
+                }
+            }
+        }
+        copy(node_summaries.begin(), node_summaries.begin() + width, out);
+    }
+    
+private:
+    // splitmix64 finaliser
+    static uint64_t mixHash(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+    
+    template <typename Locator>
+    NodeResultCache::Entry resolveCached(size_t n, const ArrivalVector* arrivals, const vector<uint64_t>& hashes,
+                                         double* tile, const Locator& locator, NodeResultCache& cache) const {
+        bool summary = locator.getConfig().combine_mode == CombineMode::summary;
+        NodeResultCache::Key key{build_generation, static_cast<uint32_t>(n),
+                                 static_cast<uint32_t>(locator.getConfig().combine_mode), hashes[n]};
+        NodeResultCache::Entry entry;
+        if (cache.find(key, entry)) {
+            return entry;
+        }
+        
+        const Node& node = nodes[n];
+        if (node.leaf) {
+            EpicenterSummary leaf[EVENT_BLOCK];
+            double error[EVENT_BLOCK];
+            solveLeafBlock(node, arrivals, 1, locator.getConfig().travel_times, tile, leaf, 
+                           summary ? nullptr : error);
+            entry.summary = leaf[0];
+            entry.result = summary ? EpicenterResult() : leaf[0].leafResult(error[0]);
+        } else {
+            EpicenterResult children[4];
+            size_t num_children = 0;
+            for (int q = 0; q < 4; q++) {
+                int child = node.children[q];
+                if (child < 0) {
+                    continue;
+                }
+                NodeResultCache::Entry resolved = resolveCached(child, arrivals, hashes, tile, locator, cache);
+                if (summary) {
+                    entry.summary.merge(resolved.summary);
+                } else if (resolved.result.confidence > 0) {
+                    children[num_children++] = resolved.result;
+                }
+            }
+            if (!summary) {
+                entry.result = locator.weightedCombination(Span<const EpicenterResult>(children, num_children));
+            }
+        }
+        cache.insert(key, entry);
+        return entry;
+    }
+    
+    void flatten(const StationQuadtree& tree, int tree_node) {
+        const StationQuadtree::Node& source = tree.getNodes()[tree_node];
+        size_t index = nodes.size();
+        nodes.push_back(Node(source.bounds));
+        nodes[index].first = static_cast<uint32_t>(station_id.size());
+        nodes[index].depth = source.depth;
+        
+        if (source.isLeaf()) {
+            for (int slot : source.stations) {
+                latitude.push_back(tree.latitude[slot]);
+                longitude.push_back(tree.longitude[slot]);
+                station_id.push_back(tree.station_id[slot]);
+            }
+            max_leaf_size = max(max_leaf_size, source.stations.size());
+        } else {
+            nodes[index].leaf = false;
+            for (int q = 0; q < 4; q++) {
+                int child = source.children[q];
+                if (tree.getNodes()[child].count > 0) {
+                    nodes[index].children[q] = static_cast<int32_t>(nodes.size());
+                    flatten(tree, child);
+                }
+            }
+        }
+        nodes[index].count = static_cast<uint32_t>(station_id.size()) - nodes[index].first;
+    }
+    
+    // With error, also fills each event's straight-ray squared residuals
+    // for EpicenterSummary::leafResult (CombineMode::result); without, the
+    // summaries' second moments (CombineMode::summary)
+    void solveLeafBlock(const Node& node, const ArrivalVector* events, size_t width,
+                        const TravelTimeTable* travel_times, double* tile, EpicenterSummary* out,
+                        double* error = nullptr) const {
+        const size_t B = EVENT_BLOCK;
+        const double nan = numeric_limits<double>::quiet_NaN();
+        const double* lat = latitude.data() + node.first;
+        const double* lon = longitude.data() + node.first;
+        const int* ids = station_id.data() + node.first;
+        size_t k = node.count;
+        
+        // Gather; lanes past width stay NaN so every loop below is B wide
+        for (size_t i = 0; i < k; i++) {
+            for (size_t e = 0; e < B; e++) {
+                const ArrivalVector* arrivals = e < width ? &events[e] : nullptr;
+                tile[i * B + e] = (arrivals && static_cast<size_t>(ids[i]) < arrivals->size()) 
+                                  ? (*arrivals)[ids[i]] : nan;
+            }
+        }
+        
+        double min_time[B];
+        size_t picks[B];
+        for (size_t e = 0; e < B; e++) {
+            min_time[e] = numeric_limits<double>::infinity();
+            picks[e] = 0;
+        }
+        for (size_t i = 0; i < k; i++) {
+            const double* t = tile + i * B;
+            for (size_t e = 0; e < B; e++) {
+                bool valid = !std::isnan(t[e]);
+                min_time[e] = valid ? min(min_time[e], t[e]) : min_time[e];
+                picks[e] += valid ? 1 : 0;
+            }
+        }
+        
+        // Inverse time weighting; stations without a pick get weight 0
+        double sum_x[B], sum_y[B], total_weight[B];
+        EpicenterSummary summaries[B];
+        for (size_t e = 0; e < B; e++) {
+            sum_x[e] = sum_y[e] = total_weight[e] = 0;
+        }
+        for (size_t i = 0; i < k; i++) {
+            const double* t = tile + i * B;
+            for (size_t e = 0; e < B; e++) {
+                double time_diff = t[e] - min_time[e];
+                double weight = std::isnan(t[e]) ? 0.0 : 1.0 / (1.0 + time_diff * time_diff);
+                sum_x[e] += lat[i] * weight;
+                sum_y[e] += lon[i] * weight;
+                total_weight[e] += weight;
+            }
+            if (!error) {
+                for (size_t e = 0; e < width; e++) {
+                    if (!std::isnan(t[e])) {
+                        double time_diff = t[e] - min_time[e];
+                        summaries[e].addMoments(lat[i], lon[i], time_diff, 1.0 / (1.0 + time_diff * time_diff));
+                    }
+                }
+            }
+        }
+        
+        if (error) {
+            double center_x[B], center_y[B];
+            for (size_t e = 0; e < B; e++) {
+                center_x[e] = sum_x[e] / total_weight[e];
+                center_y[e] = sum_y[e] / total_weight[e];
+                error[e] = 0;
+            }
+            for (size_t i = 0; i < k; i++) {
+                const double* t = tile + i * B;
+                double theoretical_time[B];
+                if (travel_times) {
+                    for (size_t e = 0; e < B; e++) {
+                        theoretical_time[e] = travel_times->travelTime(center_x[e] - lat[i], center_y[e] - lon[i]);
+                    }
+                } else {
+                    for (size_t e = 0; e < B; e++) {
+                        double dx = center_x[e] - lat[i];
+                        double dy = center_y[e] - lon[i];
+                        theoretical_time[e] = sqrt(dx * dx + dy * dy) / EarthquakeEpicenterLocator::WAVE_VELOCITY;
+                    }
+                }
+                for (size_t e = 0; e < B; e++) {
+                    double actual_time = t[e] - min_time[e];
+                    double residual = theoretical_time[e] - actual_time;
+                    error[e] += std::isnan(t[e]) ? 0.0 : residual * residual;
+                }
+            }
+        }
+        
+        for (size_t e = 0; e < width; e++) {
+            out[e] = EpicenterSummary();
+            if (picks[e] > 0) {
+                out[e] = summaries[e];
+                out[e].count = picks[e];
+                out[e].leaves = 1;
+                out[e].weight = total_weight[e];
+                out[e].weighted_lat = sum_x[e];
+                out[e].weighted_lon = sum_y[e];
+                out[e].min_arrival = min_time[e];
+            }
+        }
+    }
+};
+
+// Stores message in *error if the caller asked for it; returns false so an
+// error path can end in `return setError(error, ...)`
+static bool setError(string* error, const string& message) {
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+// Offload target for batch locates (LocatorConfig::backend). A backend
+// keeps a device copy of one StationNetwork, uploaded once: the station
+// columns in leaf order and the node table grouped by depth. Per batch it
+// uploads the stations x events arrival matrix, solves every leaf x event
+// pair in one launch and reduces the tree level by level on the device,
+// deepest level first, so only the root results come back. A CUDA or SYCL
+// backend implements this interface over device buffers; HostBackend is the
+// reference with the same layout and schedule on the CPU. locate returns
+// false (with error) when the backend cannot run the batch, and the
+// locator then falls back to the CPU path, passing the error on through
+// its BatchReport. The copy is refreshed when
+// StationNetwork::generation changes.
+class BatchBackend {
+public:
+    virtual ~BatchBackend() {}
+    
+    virtual const char* name() const = 0;
+    
+    // Locates events against network; out has one slot per event. Leaf and
+    // combine arithmetic follow StationNetwork::locateBlock (and
+    // summarizeBlock for CombineMode::summary).
+    virtual bool locate(const StationNetwork& network, Span<const ArrivalVector> events,
+                        const LocatorConfig& config, EpicenterResult* out, string* error) = 0;
+};
+
+// BatchBackend on host memory. Each launch is a grid over the leaves (or the
+// nodes of one level) split into chunks on the pool, if one is given; events
+// are the inner dimension, as device threads would be. Results are bitwise
+// equal to StationNetwork::locateBlock. Events go through in tiles of
+// EVENT_TILE to bound the per-node result buffer.
+class HostBackend : public BatchBackend {
+public:
+    static constexpr size_t EVENT_TILE = 64;
+    
+private:
+    // Device image of the network with this generation; 0 = none
+    uint64_t uploaded_generation;
+    vector<double> latitude, longitude;
+    vector<int> station_id;
+    vector<uint32_t> leaves;                 // Leaf nodes
+    vector<vector<uint32_t>> levels;         // Internal nodes by distance from the root
+    vector<array<int32_t, 4>> children;
+    vector<uint32_t> first, count;
+    
+    vector<double> arrivals;                 // stations x EVENT_TILE, station-major
+    vector<EpicenterResult> node_results;    // nodes x EVENT_TILE
+    vector<EpicenterSummary> node_summaries;
+    WorkStealingPool* pool;
+    EarthquakeEpicenterLocator combiner;     // weightedCombination only
+    
+public:
+    explicit HostBackend(WorkStealingPool* _pool = nullptr) 
+        : uploaded_generation(0), pool(_pool) {}
+    
+    const char* name() const override { return "host"; }
+    
+    bool locate(const StationNetwork& network, Span<const ArrivalVector> events,
+                const LocatorConfig& config, EpicenterResult* out, string* error) override {
+        if (network.getNodes().empty()) {
+            return setError(error, "empty network");
+        }
+        if (uploaded_generation != network.generation()) {
+            upload(network);
+        }
+        bool summary = config.combine_mode == CombineMode::summary;
+        for (size_t first_event = 0; first_event < events.size(); first_event += EVENT_TILE) {
+            size_t width = min(EVENT_TILE, events.size() - first_event);
+            uploadArrivals(events.subspan(first_event, width));
+            if (summary) {
+                run(node_summaries, width, config.travel_times);
+                for (size_t e = 0; e < width; e++) {
+                    out[first_event + e] = node_summaries[e].result();
+                }
+            } else {
+                run(node_results, width, config.travel_times);
+                copy(node_results.begin(), node_results.begin() + width, out + first_event);
+            }
+        }
+        return true;
+    }
+    
+private:
+    void upload(const StationNetwork& network) {
+        Span<const StationNetwork::Node> nodes = network.getNodes();
+        StationSetView stations = network.stations();
+        latitude.assign(stations.latitude, stations.latitude + stations.size());
+        longitude.assign(stations.longitude, stations.longitude + stations.size());
+        station_id.assign(stations.id, stations.id + stations.size());
+        
+        leaves.clear();
+        levels.clear();
+        children.resize(nodes.size());
+        first.resize(nodes.size());
+        count.resize(nodes.size());
+        for (size_t n = 0; n < nodes.size(); n++) {
+            const StationNetwork::Node& node = nodes[n];
+            copy(node.children, node.children + 4, children[n].begin());
+            first[n] = node.first;
+            count[n] = node.count;
+            if (node.leaf) {
+                leaves.push_back(static_cast<uint32_t>(n));
+            }
+        }
+        // Levels come from the child links rather than the stored depths,
+        // so the sweep in run() finishes every child before its parent
+        vector<uint32_t> level;
+        if (!nodes[0].leaf) {
+            level.push_back(0);
+        }
+        while (!level.empty()) {
+            vector<uint32_t> next;
+            for (uint32_t n : level) {
+                for (int32_t child : nodes[n].children) {
+                    if (child >= 0 && !nodes[child].leaf) {
+                        next.push_back(static_cast<uint32_t>(child));
+                    }
+                }
+            }
+            levels.push_back(move(level));
+            level = move(next);
+        }
+        node_results.assign(nodes.size() * EVENT_TILE, EpicenterResult());
+        node_summaries.assign(nodes.size() * EVENT_TILE, EpicenterSummary());
+        uploaded_generation = network.generation();
+    }
+    
+    // Gathers the tile's arrival times by station id; missing picks are NaN.
+    // Groups of GROUP events sweep the stations in blocks, which keeps both
+    // the group's source vectors and the transposed rows being written in
+    // cache.
+    void uploadArrivals(Span<const ArrivalVector> events) {
+        const double nan = numeric_limits<double>::quiet_NaN();
+        const size_t GROUP = 8, BLOCK = 256;
+        size_t n = station_id.size();
+        arrivals.resize(n * EVENT_TILE);
+        for (size_t group = 0; group < EVENT_TILE; group += GROUP) {
+            for (size_t begin = 0; begin < n; begin += BLOCK) {
+                size_t end = min(begin + BLOCK, n);
+                for (size_t e = group; e < group + GROUP; e++) {
+                    const ArrivalVector* times = e < events.size() ? &events[e] : nullptr;
+                    for (size_t i = begin; i < end; i++) {
+                        int id = station_id[i];
+                        arrivals[i * EVENT_TILE + e] = (times && static_cast<size_t>(id) < times->size()) 
+                                                       ? (*times)[id] : nan;
+                    }
+                }
+            }
+        }
+    }
+    
+    // Runs body(i) for i in [0, n) as one launch
+    template <typename Body>
+    void launch(size_t n, Body body) {
+        const size_t CHUNK = 64;
+        if (!pool || n <= CHUNK) {
+            for (size_t i = 0; i < n; i++) {
+                body(i);
+            }
+            return;
+        }
+        TaskGroup group(*pool);
+        for (size_t begin = 0; begin < n; begin += CHUNK) {
+            size_t end = min(begin + CHUNK, n);
+            group.run([&body, begin, end] {
+                for (size_t i = begin; i < end; i++) {
+                    body(i);
+                }
+            });
+        }
+        group.wait();
+    }
+    
+    template <typename Estimate>
+    void run(vector<Estimate>& slots, size_t width, const TravelTimeTable* travel_times) {
+        launch(leaves.size(), [&](size_t l) {
+            uint32_t node = leaves[l];
+            EpicenterSummary leaf[EVENT_TILE];
+            double error[EVENT_TILE] = {};
+            solveLeaf(node, width, travel_times, leaf, leafError(error, static_cast<Estimate*>(nullptr)));
+            for (size_t e = 0; e < width; e++) {
+                slots[node * EVENT_TILE + e] = finishLeaf(leaf[e], error[e], static_cast<Estimate*>(nullptr));
+            }
+        });
+        for (size_t depth = levels.size(); depth-- > 0;) {
+            const vector<uint32_t>& level = levels[depth];
+            launch(level.size(), [&](size_t k) {
+                uint32_t node = level[k];
+                for (size_t e = 0; e < width; e++) {
+                    slots[node * EVENT_TILE + e] = combine(node, e, slots);
+                }
+            });
+        }
+    }
+    
+    // One leaf for every event of the tile. Events are the inner loop over
+    // contiguous arrivals, one lane per event as one device thread would
+    // be, each following one lane of StationNetwork::solveLeafBlock: with
+    // error the straight-ray squared residuals, without the second moments.
+    void solveLeaf(uint32_t node, size_t width, const TravelTimeTable* travel_times,
+                   EpicenterSummary* out, double* error) const {
+        const size_t E = EVENT_TILE;
+        size_t begin = first[node], end = first[node] + count[node];
+        double min_time[E], sum_x[E], sum_y[E], total_weight[E];
+        size_t picks[E];
+        for (size_t e = 0; e < E; e++) {
+            min_time[e] = numeric_limits<double>::infinity();
+            picks[e] = 0;
+            sum_x[e] = sum_y[e] = total_weight[e] = 0;
+            out[e] = EpicenterSummary();
+        }
+        for (size_t i = begin; i < end; i++) {
+            const double* t = &arrivals[i * E];
+            for (size_t e = 0; e < E; e++) {
+                bool valid = !std::isnan(t[e]);
+                min_time[e] = valid ? min(min_time[e], t[e]) : min_time[e];
+                picks[e] += valid ? 1 : 0;
+            }
+        }
+        for (size_t i = begin; i < end; i++) {
+            const double* t = &arrivals[i * E];
+            for (size_t e = 0; e < E; e++) {
+                double time_diff = t[e] - min_time[e];
+                double weight = std::isnan(t[e]) ? 0.0 : 1.0 / (1.0 + time_diff * time_diff);
+                sum_x[e] += latitude[i] * weight;
+                sum_y[e] += longitude[i] * weight;
+                total_weight[e] += weight;
+            }
+            if (!error) {
+                for (size_t e = 0; e < width; e++) {
+                    if (!std::isnan(t[e])) {
+                        double time_diff = t[e] - min_time[e];
+                        out[e].addMoments(latitude[i], longitude[i], time_diff, 1.0 / (1.0 + time_diff * time_diff));
+                    }
+                }
+            }
+        }
+        if (error) {
+            double center_x[E], center_y[E];
+            for (size_t e = 0; e < E; e++) {
+                center_x[e] = sum_x[e] / total_weight[e];
+                center_y[e] = sum_y[e] / total_weight[e];
+                error[e] = 0;
+            }
+            for (size_t i = begin; i < end; i++) {
+                const double* t = &arrivals[i * E];
+                double theoretical_time[E];
+                if (travel_times) {
+                    for (size_t e = 0; e < width; e++) {
+                        theoretical_time[e] = travel_times->travelTime(center_x[e] - latitude[i], 
+                                                                       center_y[e] - longitude[i]);
+                    }
+                } else {
+                    for (size_t e = 0; e < E; e++) {
+                        double dx = center_x[e] - latitude[i];
+                        double dy = center_y[e] - longitude[i];
+                        theoretical_time[e] = sqrt(dx * dx + dy * dy) / EarthquakeEpicenterLocator::WAVE_VELOCITY;
+                    }
+                }
+                for (size_t e = 0; e < width; e++) {
+                    double residual = theoretical_time[e] - (t[e] - min_time[e]);
+                    error[e] += std::isnan(t[e]) ? 0.0 : residual * residual;
+                }
+            }
+        }
+        
+        for (size_t e = 0; e < width; e++) {
+            if (picks[e] > 0) {
+                out[e].count = picks[e];
+                out[e].leaves = 1;
+                out[e].weight = total_weight[e];
+                out[e].weighted_lat = sum_x[e];
+                out[e].weighted_lon = sum_y[e];
+                out[e].min_arrival = min_time[e];
+            } else {
+                out[e] = EpicenterSummary();
+            }
+        }
+    }
+    
+    static double* leafError(double* error, EpicenterResult*) { return error; }
+    static double* leafError(double*, EpicenterSummary*) { return nullptr; }
+    static EpicenterResult finishLeaf(const EpicenterSummary& summary, double error, EpicenterResult*) { 
+        return summary.leafResult(error); 
+    }
+    static EpicenterSummary finishLeaf(const EpicenterSummary& summary, double, EpicenterSummary*) { 
+        return summary; 
+    }
+    
+    // weightedCombination of the children with an estimate, in quadrant order
+    EpicenterResult combine(uint32_t node, size_t e, const vector<EpicenterResult>& slots) const {
+        EpicenterResult results[4];
+        size_t num_results = 0;
+        for (int q = 0; q < 4; q++) {
+            int child = children[node][q];
+            if (child >= 0 && slots[child * EVENT_TILE + e].confidence > 0) {
+                results[num_results++] = slots[child * EVENT_TILE + e];
+            }
+        }
+        return combiner.weightedCombination(Span<const EpicenterResult>(results, num_results));
+    }
+    
+    EpicenterSummary combine(uint32_t node, size_t e, const vector<EpicenterSummary>& slots) const {
+        EpicenterSummary summary;
+        for (int q = 0; q < 4; q++) {
+            int child = children[node][q];
+            if (child >= 0) {
+                summary.merge(slots[child * EVENT_TILE + e]);
+            }
+        }
+        return summary;
+    }
+};
+
+// Batch locate: one shared decomposition, events in blocks of EVENT_BLOCK.
+// Blocks are independent, so ExecPolicy::parallel spreads them over the pool.
+template <int BaseCaseSize>
+vector<EpicenterResult> BasicEpicenterLocator<BaseCaseSize>::locateEpicenters(const StationNetwork& network,
+                                                                              Span<const ArrivalVector> events,
+                                                                              ExecPolicy policy,
+                                                                              BatchReport* report) {
+    vector<EpicenterResult> results(events.size());
+    BatchReport outcome;
+    if (config.result_cache) {
+        for (size_t e = 0; e < events.size(); e++) {
+            results[e] = network.locateCached(events[e], *this, *config.result_cache);
+        }
+        outcome.cached = true;
+        if (report) {
+            *report = outcome;
+        }
+        return results;
+    }
+    if (config.backend) {
+        if (config.backend->locate(network, events, config, results.data(), &outcome.backend_error)) {
+            outcome.offloaded = true;
+            if (report) {
+                *report = outcome;
+            }
+            return results;
+        }
+        outcome.fell_back = true;
+        if (outcome.backend_error.empty()) {
+            outcome.backend_error = string(config.backend->name()) + " backend failed";
+        }
+    }
+    if (report) {
+        *report = outcome;
+    }
+    const size_t B = StationNetwork::EVENT_BLOCK;
+    size_t num_blocks = (events.size() + B - 1) / B;
+    
+    auto solve_block = [&](size_t block) {
+        size_t first = block * B;
+        size_t width = min(B, events.size() - first);
+        if (config.use_arena) {
+            ScratchArena arena(config.arena_initial_bytes);
+            network.locateBlock(events.data() + first, width, results.data() + first, *this, 
+                                arena.resource());
+        } else {
+            network.locateBlock(events.data() + first, width, results.data() + first, *this);
+        }
+    };
+    
+    if (policy == ExecPolicy::parallel && num_blocks > 1) {
+        TaskGroup group(threadPool());
+        for (size_t block = 1; block < num_blocks; block++) {
+            group.run([&solve_block, block] { solve_block(block); });
+        }
+        solve_block(0);
+        group.wait();
+    } else {
+        for (size_t block = 0; block < num_blocks; block++) {
+            solve_block(block);
+        }
+    }
+    return results;
+}
+
+// Wire format between a DistributedNetwork coordinator and its TileServers.
+// Every message is one flat buffer in the sender's byte order: a byte-order
+// mark, the message type, then the body. Readers bounds-check every field,
+// so a truncated or foreign buffer is rejected rather than misread. A
+// subtree's child links, station ranges and depths are checked as well;
+// node bounds and leaf flags are taken as sent.
+//
+//   LOAD     u32 tiles, per tile: u32 tile id, subtree network
+//   LOCATE   u32 events, u64 stations, u32 combine mode, events x stations
+//            arrival times
+//   RESULTS  u32 tiles, u32 events, per tile: u32 tile id, events x result
+//            (or x summary for CombineMode::summary)
+//   ACK      (empty)
+//   FAILURE  u32 length, message text
+//
+// A subtree network is u32 nodes, per node the bounds, station range,
+// children (relative to the node, -1 = none), depth and leaf flag, then
+// u64 stations and the latitude, longitude and id columns. A result is
+// location, confidence and error as four doubles; a summary is its u64
+// count and leaves, then its eleven doubles in declaration order.
+struct TileCodec {
+    enum Message : uint32_t { LOAD = 1, LOCATE = 2, RESULTS = 3, ACK = 4, FAILURE = 5 };
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    
+    class Writer {
+    private:
+        vector<uint8_t>& out;
+        
+    public:
+        Writer(vector<uint8_t>& _out, Message type) : out(_out) {
+            out.clear();
+            put(BYTE_ORDER_MARK);
+            put(static_cast<uint32_t>(type));
+        }
+        
+        template <typename T>
+        void put(const T& value) { putArray(&value, 1); }
+        
+        template <typename T>
+        void putArray(const T* values, size_t n) {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values);
+            out.insert(out.end(), bytes, bytes + n * sizeof(T));
+        }
+        
+        void putResult(const EpicenterResult& result) {
+            double fields[4] = {result.location.x, result.location.y, result.confidence, result.error};
+            putArray(fields, 4);
+        }
+        
+        void putResult(const EpicenterSummary& summary) {
+            double fields[11] = {summary.weight, summary.weighted_lat, summary.weighted_lon,
+                                 summary.min_arrival, summary.weighted_time, summary.lat_lat,
+                                 summary.lat_lon, summary.lon_lon, summary.lat_time, summary.lon_time,
+                                 summary.time_time};
+            put(static_cast<uint64_t>(summary.count));
+            put(static_cast<uint64_t>(summary.leaves));
+            putArray(fields, 11);
+        }
+    };
+    
+    class Reader {
+    private:
+        const uint8_t* cursor;
+        const uint8_t* end;
+        
+    public:
+        Reader(const vector<uint8_t>& message) 
+            : cursor(message.data()), end(message.data() + message.size()) {}
+        
+        // Checks the byte-order mark; type is the message that follows
+        bool header(Message& type) {
+            uint32_t mark, value;
+            if (!get(mark) || mark != BYTE_ORDER_MARK || !get(value)) {
+                return false;
+            }
+            type = static_cast<Message>(value);
+            return true;
+        }
+        
+        template <typename T>
+        bool get(T& value) { return getArray(&value, 1); }
+        
+        template <typename T>
+        bool getArray(T* values, size_t n) {
+            if (n > remaining() / sizeof(T)) {
+                return false;
+            }
+            if (n == 0) {
+                return true;  // values may be null
+            }
+            memcpy(values, cursor, n * sizeof(T));
+            cursor += n * sizeof(T);
+            return true;
+        }
+        
+        // Resizes to n only once the bytes are known to be there
+        template <typename Vector>
+        bool getVector(Vector& values, size_t n) {
+            if (n > remaining() / sizeof(values[0])) {
+                return false;
+            }
+            values.resize(n);
+            return getArray(values.data(), n);
+        }
+        
+        bool getResult(EpicenterResult& result) {
+            double fields[4];
+            if (!getArray(fields, 4)) {
+                return false;
+            }
+            result = EpicenterResult(Point(fields[0], fields[1]), fields[2], fields[3]);
+            return true;
+        }
+        
+        bool getResult(EpicenterSummary& summary) {
+            uint64_t count, leaves;
+            double fields[11];
+            if (!get(count) || !get(leaves) || !getArray(fields, 11)) {
+                return false;
+            }
+            summary.count = static_cast<size_t>(count);
+            summary.leaves = static_cast<size_t>(leaves);
+            summary.weight = fields[0];
+            summary.weighted_lat = fields[1];
+            summary.weighted_lon = fields[2];
+            summary.min_arrival = fields[3];
+            summary.weighted_time = fields[4];
+            summary.lat_lat = fields[5];
+            summary.lat_lon = fields[6];
+            summary.lon_lon = fields[7];
+            summary.lat_time = fields[8];
+            summary.lon_time = fields[9];
+            summary.time_time = fields[10];
+            return true;
+        }
+        
+        size_t remaining() const { return static_cast<size_t>(end - cursor); }
+    };
+    
+    // One past the last node of a subtree (nodes are in preorder)
+    static size_t subtreeEnd(const StationNetwork& network, size_t node) {
+        size_t end = node + 1;
+        while (end < network.nodes.size() && network.nodes[end].depth > network.nodes[node].depth) {
+            end++;
+        }
+        return end;
+    }
+    
+    // Writes the subtree under node as a standalone network whose station
+    // ids are renumbered first_id, first_id + 1, ... in leaf order
+    static void writeSubtree(Writer& out, const StationNetwork& network, size_t node, int first_id) {
+        size_t end = subtreeEnd(network, node);
+        uint32_t first = network.nodes[node].first;
+        out.put(static_cast<uint32_t>(end - node));
+        for (size_t k = node; k < end; k++) {
+            const StationNetwork::Node& source = network.nodes[k];
+            double bounds[4] = {source.bounds.min_lat, source.bounds.max_lat, 
+                                source.bounds.min_lon, source.bounds.max_lon};
+            out.putArray(bounds, 4);
+            out.put(source.first - first);
+            out.put(source.count);
+            for (int q = 0; q < 4; q++) {
+                out.put(source.children[q] < 0 ? int32_t(-1) : static_cast<int32_t>(source.children[q] - k));
+            }
+            out.put(source.depth);
+            out.put(static_cast<uint8_t>(source.leaf));
+        }
+        
+        uint32_t count = network.nodes[node].count;
+        out.put(static_cast<uint64_t>(count));
+        out.putArray(network.latitude.data() + first, count);
+        out.putArray(network.longitude.data() + first, count);
+        for (uint32_t i = 0; i < count; i++) {
+            out.put(static_cast<int32_t>(first_id + static_cast<int>(i)));
+        }
+    }
+    
+    // Reads a subtree network, checking that every node's children and
+    // station range stay inside the network, that depths follow the tree
+    // down from a non-negative root depth, and that no station id is
+    // negative. Bounds and leaf flags are taken as sent.
+    static bool readNetwork(Reader& in, StationNetwork& network) {
+        uint32_t num_nodes;
+        if (!in.get(num_nodes) || num_nodes == 0) {
+            return false;
+        }
+        network.nodes.clear();
+        network.max_leaf_size = 0;
+        network.build_generation = StationNetwork::nextGeneration();
+        for (uint32_t k = 0; k < num_nodes; k++) {
+            double bounds[4];
+            StationNetwork::Node node(GeoBounds{});
+            uint8_t leaf;
+            if (!in.getArray(bounds, 4) || !in.get(node.first) || !in.get(node.count) ||
+                !in.getArray(node.children, 4) || !in.get(node.depth) || !in.get(leaf)) {
+                return false;
+            }
+            node.bounds = GeoBounds(bounds[0], bounds[1], bounds[2], bounds[3]);
+            node.leaf = leaf != 0;
+            for (int q = 0; q < 4; q++) {
+                if (node.children[q] >= 0) {
+                    if (node.children[q] == 0 || node.children[q] >= static_cast<int32_t>(num_nodes - k)) {
+                        return false;  // Children must follow their parent
+                    }
+                    node.children[q] += static_cast<int32_t>(k);
+                }
+            }
+            if (node.leaf) {
+                network.max_leaf_size = max(network.max_leaf_size, static_cast<size_t>(node.count));
+            }
+            network.nodes.push_back(node);
+        }
+        // The subtree root keeps its depth in the coordinator's tree
+        if (network.nodes[0].depth < 0 || !network.depthsFollowTree(network.nodes[0].depth)) {
+            return false;
+        }
+        
+        uint64_t count;
+        if (!in.get(count) || count != network.nodes[0].count ||
+            !in.getVector(network.latitude, count) || !in.getVector(network.longitude, count) ||
+            !in.getVector(network.station_id, count)) {
+            return false;
+        }
+        for (const auto& node : network.nodes) {
+            if (uint64_t(node.first) + node.count > count) {
+                return false;
+            }
+        }
+        // The coordinator numbers stations first_id + i, so a negative id
+        // can only come from a foreign or corrupt buffer
+        for (int32_t id : network.station_id) {
+            if (id < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    static void writeFailure(vector<uint8_t>& reply, const string& message) {
+        Writer out(reply, FAILURE);
+        out.put(static_cast<uint32_t>(message.size()));
+        out.putArray(message.data(), message.size());
+    }
+};
+
+// Node side of a distributed network: owns the tiles a coordinator loaded
+// into it and answers LOCATE requests with one result per tile and event.
+// Stations are numbered by the node in load order, so a LOCATE carries
+// exactly this node's arrivals, position for position.
+class TileServer {
+private:
+    EarthquakeEpicenterLocator locator;   // Leaf solver and combine
+    vector<StationNetwork> tiles;
+    vector<uint32_t> tile_ids;
+    size_t num_stations;
+    
+public:
+    explicit TileServer(const LocatorConfig& config = LocatorConfig()) 
+        : locator(config), num_stations(0) {}
+    
+    size_t tileCount() const { return tiles.size(); }
+    size_t size() const { return num_stations; }
+    
+    // Answers one request; malformed requests get a FAILURE reply
+    void handle(const vector<uint8_t>& request, vector<uint8_t>& reply) {
+        TileCodec::Reader in(request);
+        TileCodec::Message type;
+        if (!in.header(type)) {
+            TileCodec::writeFailure(reply, "bad message header");
+        } else if (type == TileCodec::LOAD) {
+            load(in, reply);
+        } else if (type == TileCodec::LOCATE) {
+            locate(in, reply);
+        } else {
+            TileCodec::writeFailure(reply, "unexpected message type " + to_string(type));
+        }
+    }
+    
+private:
+    void load(TileCodec::Reader& in, vector<uint8_t>& reply) {
+        tiles.clear();
+        tile_ids.clear();
+        num_stations = 0;
+        uint32_t num_tiles;
+        if (!in.get(num_tiles)) {
+            return TileCodec::writeFailure(reply, "truncated LOAD");
+        }
+        for (uint32_t t = 0; t < num_tiles; t++) {
+            uint32_t id;
+            StationNetwork tile;
+            if (!in.get(id) || !TileCodec::readNetwork(in, tile)) {
+                tiles.clear();
+                tile_ids.clear();
+                num_stations = 0;
+                return TileCodec::writeFailure(reply, "malformed tile " + to_string(t));
+            }
+            num_stations += tile.size();
+            tiles.push_back(move(tile));
+            tile_ids.push_back(id);
+        }
+        TileCodec::Writer(reply, TileCodec::ACK);
+    }
+    
+    void locate(TileCodec::Reader& in, vector<uint8_t>& reply) {
+        uint32_t num_events, mode;
+        uint64_t count;
+        if (!in.get(num_events) || !in.get(count) || !in.get(mode) || count != num_stations ||
+            in.remaining() != uint64_t(num_events) * count * sizeof(double)) {
+            return TileCodec::writeFailure(reply, "LOCATE does not match the loaded tiles");
+        }
+        vector<ArrivalVector> events(num_events);
+        for (auto& arrivals : events) {
+            in.getVector(arrivals, count);
+        }
+        
+        TileCodec::Writer out(reply, TileCodec::RESULTS);
+        out.put(static_cast<uint32_t>(tiles.size()));
+        out.put(num_events);
+        const size_t B = StationNetwork::EVENT_BLOCK;
+        EpicenterResult results[B];
+        EpicenterSummary summaries[B];
+        bool summary = mode == static_cast<uint32_t>(CombineMode::summary);
+        for (size_t t = 0; t < tiles.size(); t++) {
+            out.put(tile_ids[t]);
+            for (size_t first = 0; first < events.size(); first += B) {
+                size_t width = min(B, events.size() - first);
+                if (summary) {
+                    tiles[t].summarizeBlock(events.data() + first, width, summaries, locator);
+                } else {
+                    tiles[t].locateBlock(events.data() + first, width, results, locator);
+                }
+                for (size_t e = 0; e < width; e++) {
+                    if (summary) {
+                        out.putResult(summaries[e]);
+                    } else {
+                        out.putResult(results[e]);
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Message channel from a coordinator to the nodes of a distributed network.
+// An MPI or RPC implementation sends the request to the node's TileServer
+// and returns its reply; exchanges with different nodes may run
+// concurrently, exchanges with one node do not.
+class TileTransport {
+public:
+    virtual ~TileTransport() {}
+    
+    virtual size_t nodeCount() const = 0;
+    
+    // Sends request to node and waits for the reply; false (and error) if
+    // the node cannot be reached
+    virtual bool exchange(size_t node, const vector<uint8_t>& request, vector<uint8_t>& reply,
+                          string* error) = 0;
+};
+
+// In-process transport: every node is a local TileServer. Requests still go
+// through the wire format, so it exercises the same path as a remote node.
+class LoopbackTransport : public TileTransport {
+private:
+    vector<unique_ptr<TileServer>> servers;
+    
+public:
+    explicit LoopbackTransport(size_t num_nodes, const LocatorConfig& config = LocatorConfig()) {
+        for (size_t i = 0; i < num_nodes; i++) {
+            servers.emplace_back(new TileServer(config));
+        }
+    }
+    
+    size_t nodeCount() const override { return servers.size(); }
+    
+    bool exchange(size_t node, const vector<uint8_t>& request, vector<uint8_t>& reply,
+                  string* error) override {
+        if (node >= servers.size()) {
+            return setError(error, "no node " + to_string(node));
+        }
+        servers[node]->handle(request, reply);
+        return true;
+    }
+    
+    const TileServer& server(size_t node) const { return *servers[node]; }
+};
+
+// Scatter/gather over a StationNetwork. The nodes at tile_depth (and leaves
+// above it) are tiles; each tile's subtree is shipped once to the node that
+// owns it. Per event batch every node locates its own tiles and returns one
+// EpicenterResult per tile and event (an EpicenterSummary with
+// CombineMode::summary), which is all the combine above the tiles reads, so
+// the coordinator finishes the tree from those alone. With the nodes'
+// locators configured like the coordinator's, results equal
+// locateEpicenters on the whole network bit for bit.
+//
+// Tiles are assigned by station count, the leaf-solve cost, with the
+// longest-processing-time rule: largest tile first, to the least loaded
+// node. Dense tiles therefore spread out while sparse ones pack together.
+// distribute() re-plans and reloads, e.g. after the network changes.
+class DistributedNetwork {
+public:
+    struct Tile {
+        uint32_t node;            // Network node at the tile's root
+        size_t count;             // Stations in the tile
+        size_t owner;             // Transport node
+        size_t first_station;     // Offset in the owner's station numbering
+    };
+    
+private:
+    // Nodes above and at the tiles in preorder; children index this list
+    struct PlanEntry {
+        int32_t children[4];      // -1 = none
+        int32_t tile;             // -1 = combine node
+    };
+    
+    const StationNetwork& network;
+    TileTransport& transport;
+    EarthquakeEpicenterLocator locator;   // Combine above the tiles
+    int tile_depth;
+    vector<Tile> tiles;
+    vector<PlanEntry> plan;
+    vector<vector<uint32_t>> node_tiles;  // Tiles per node in load order
+    vector<vector<int>> node_station_ids; // Network ids of each node's stations
+    
+public:
+    DistributedNetwork(const StationNetwork& _network, TileTransport& _transport, int _tile_depth = 3,
+                       const LocatorConfig& config = LocatorConfig())
+        : network(_network), transport(_transport), locator(config), tile_depth(max(_tile_depth, 0)) {}
+    
+    size_t tileCount() const { return tiles.size(); }
+    const vector<Tile>& getTiles() const { return tiles; }
+    
+    // Stations assigned to each node
+    vector<size_t> nodeLoads() const {
+        vector<size_t> loads(transport.nodeCount(), 0);
+        for (const auto& tile : tiles) {
+            loads[tile.owner] += tile.count;
+        }
+        return loads;
+    }
+    
+    // Plans the tiles, assigns them and loads every node
+    bool distribute(string* error = nullptr) {
+        size_t num_nodes = transport.nodeCount();
+        if (num_nodes == 0) {
+            return setError(error, "transport has no nodes");
+        }
+        planTiles();
+        
+        vector<size_t> weights;
+        for (const auto& tile : tiles) {
+            weights.push_back(tile.count);
+        }
+        vector<size_t> owners = assignTiles(Span<const size_t>(weights), num_nodes);
+        node_tiles.assign(num_nodes, vector<uint32_t>());
+        node_station_ids.assign(num_nodes, vector<int>());
+        StationSetView stations = network.stations();
+        for (size_t t = 0; t < tiles.size(); t++) {
+            Tile& tile = tiles[t];
+            tile.owner = owners[t];
+            if (tile.count == 0) {
+                continue;  // Empty root: nothing to solve remotely
+            }
+            vector<int>& ids = node_station_ids[tile.owner];
+            tile.first_station = ids.size();
+            const StationNetwork::Node& root = network.getNodes()[tile.node];
+            ids.insert(ids.end(), stations.id + root.first, stations.id + root.first + root.count);
+            node_tiles[tile.owner].push_back(static_cast<uint32_t>(t));
+        }
+        
+        vector<vector<uint8_t>> requests(num_nodes), replies(num_nodes);
+        for (size_t node = 0; node < num_nodes; node++) {
+            TileCodec::Writer out(requests[node], TileCodec::LOAD);
+            out.put(static_cast<uint32_t>(node_tiles[node].size()));
+            for (uint32_t t : node_tiles[node]) {
+                out.put(t);
+                TileCodec::writeSubtree(out, network, tiles[t].node, static_cast<int>(tiles[t].first_station));
+            }
+        }
+        if (!exchangeAll(requests, replies, nullptr, error)) {
+            return false;
+        }
+        for (size_t node = 0; node < num_nodes; node++) {
+            TileCodec::Reader in(replies[node]);
+            TileCodec::Message type;
+            if (!in.header(type) || type != TileCodec::ACK) {
+                return setError(error, "node " + to_string(node) + " rejected its tiles: " + failureText(replies[node]));
+            }
+        }
+        return true;
+    }
+    
+    // Locates a batch of events (arrival times by network station id). The
+    // exchanges with the nodes run on pool when one is given.
+    bool locate(Span<const ArrivalVector> events, vector<EpicenterResult>& results,
+                string* error = nullptr, WorkStealingPool* pool = nullptr) {
+        if (plan.empty()) {
+            return setError(error, "distribute() has not run");
+        }
+        size_t num_nodes = node_tiles.size();
+        size_t num_events = events.size();
+        vector<vector<uint8_t>> requests(num_nodes), replies(num_nodes);
+        for (size_t node = 0; node < num_nodes; node++) {
+            const vector<int>& ids = node_station_ids[node];
+            TileCodec::Writer out(requests[node], TileCodec::LOCATE);
+            out.put(static_cast<uint32_t>(num_events));
+            out.put(static_cast<uint64_t>(ids.size()));
+            out.put(static_cast<uint32_t>(locator.getConfig().combine_mode));
+            vector<double> row(ids.size());
+            for (const auto& arrivals : events) {
+                for (size_t i = 0; i < ids.size(); i++) {
+                    row[i] = static_cast<size_t>(ids[i]) < arrivals.size() 
+                             ? arrivals[ids[i]] : numeric_limits<double>::quiet_NaN();
+                }
+                out.putArray(row.data(), row.size());
+            }
+        }
+        if (!exchangeAll(requests, replies, pool, error)) {
+            return false;
+        }
+        if (locator.getConfig().combine_mode == CombineMode::summary) {
+            return gather<EpicenterSummary>(replies, num_events, results, error);
+        }
+        return gather<EpicenterResult>(replies, num_events, results, error);
+    }
+    
+    // Longest-processing-time assignment of weighted items to num_bins
+    // bins; returns each item's bin. Ties go to the lower bin, so the
+    // assignment is deterministic.
+    static vector<size_t> assignTiles(Span<const size_t> weights, size_t num_bins) {
+        vector<size_t> order(weights.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return weights[a] > weights[b]; });
+        
+        vector<size_t> owners(weights.size(), 0);
+        vector<size_t> loads(num_bins, 0);
+        for (size_t item : order) {
+            size_t bin = min_element(loads.begin(), loads.end()) - loads.begin();
+            owners[item] = bin;
+            loads[bin] += weights[item];
+        }
+        return owners;
+    }
+    
+private:
+    // Walks the preorder nodes, cutting at tile_depth and at shallower leaves
+    void planTiles() {
+        tiles.clear();
+        plan.clear();
+        Span<const StationNetwork::Node> nodes = network.getNodes();
+        vector<int32_t> entry_of_node(nodes.size(), -1);
+        vector<size_t> node_of_entry;
+        size_t k = 0;
+        while (k < nodes.size()) {
+            PlanEntry entry;
+            fill(entry.children, entry.children + 4, -1);
+            entry.tile = -1;
+            entry_of_node[k] = static_cast<int32_t>(plan.size());
+            node_of_entry.push_back(k);
+            if (nodes[k].leaf || nodes[k].depth >= tile_depth) {
+                entry.tile = static_cast<int32_t>(tiles.size());
+                tiles.push_back(Tile{static_cast<uint32_t>(k), nodes[k].count, 0, 0});
+                plan.push_back(entry);
+                k = TileCodec::subtreeEnd(network, k);
+            } else {
+                plan.push_back(entry);
+                k++;
+            }
+        }
+        for (size_t p = 0; p < plan.size(); p++) {
+            if (plan[p].tile >= 0) {
+                continue;
+            }
+            for (int q = 0; q < 4; q++) {
+                int child = nodes[node_of_entry[p]].children[q];
+                plan[p].children[q] = child < 0 ? -1 : entry_of_node[child];
+            }
+        }
+    }
+    
+    // Parses the RESULTS replies and finishes the tree above the tiles
+    template <typename Estimate>
+    bool gather(const vector<vector<uint8_t>>& replies, size_t num_events,
+                vector<EpicenterResult>& results, string* error) const {
+        size_t num_nodes = replies.size();
+        vector<Estimate> tile_results(tiles.size() * num_events);
+        for (size_t node = 0; node < num_nodes; node++) {
+            TileCodec::Reader in(replies[node]);
+            TileCodec::Message type;
+            uint32_t num_tiles, width;
+            if (!in.header(type) || type != TileCodec::RESULTS) {
+                return setError(error, "node " + to_string(node) + ": " + failureText(replies[node]));
+            }
+            if (!in.get(num_tiles) || !in.get(width) || num_tiles != node_tiles[node].size() ||
+                width != num_events) {
+                return setError(error, "node " + to_string(node) + " returned the wrong shape");
+            }
+            for (uint32_t expected : node_tiles[node]) {
+                uint32_t t;
+                if (!in.get(t) || t != expected) {
+                    return setError(error, "node " + to_string(node) + " returned an unknown tile");
+                }
+                for (size_t e = 0; e < num_events; e++) {
+                    if (!in.getResult(tile_results[t * num_events + e])) {
+                        return setError(error, "node " + to_string(node) + ": truncated results");
+                    }
+                }
+            }
+        }
+        
+        // Children follow parents in the plan, so a reverse sweep combines bottom-up
+        results.resize(num_events);
+        vector<Estimate> slots(plan.size());
+        for (size_t e = 0; e < num_events; e++) {
+            for (size_t p = plan.size(); p-- > 0;) {
+                const PlanEntry& entry = plan[p];
+                if (entry.tile >= 0) {
+                    slots[p] = tile_results[entry.tile * num_events + e];
+                } else {
+                    slots[p] = combineEntry(entry, slots.data());
+                }
+            }
+            results[e] = finish(slots[0]);
+        }
+        return true;
+    }
+    
+    // Same combine as StationNetwork::locateBlock and summarizeBlock
+    EpicenterResult combineEntry(const PlanEntry& entry, const EpicenterResult* slots) const {
+        EpicenterResult children[4];
+        size_t num_children = 0;
+        for (int q = 0; q < 4; q++) {
+            int child = entry.children[q];
+            if (child >= 0 && slots[child].confidence > 0) {
+                children[num_children++] = slots[child];
+            }
+        }
+        return locator.weightedCombination(Span<const EpicenterResult>(children, num_children));
+    }
+    
+    EpicenterSummary combineEntry(const PlanEntry& entry, const EpicenterSummary* slots) const {
+        EpicenterSummary summary;
+        for (int q = 0; q < 4; q++) {
+            if (entry.children[q] >= 0) {
+                summary.merge(slots[entry.children[q]]);
+            }
+        }
+        return summary;
+    }
+    
+    static EpicenterResult finish(const EpicenterResult& result) { return result; }
+    static EpicenterResult finish(const EpicenterSummary& summary) { return summary.result(); }
+    
+    bool exchangeAll(const vector<vector<uint8_t>>& requests, vector<vector<uint8_t>>& replies,
+                     WorkStealingPool* pool, string* error) {
+        size_t num_nodes = requests.size();
+        vector<string> errors(num_nodes);
+        vector<char> ok(num_nodes, 1);
+        auto exchange = [&](size_t node) {
+            ok[node] = transport.exchange(node, requests[node], replies[node], &errors[node]);
+        };
+        if (pool && num_nodes > 1) {
+            TaskGroup group(*pool);
+            for (size_t node = 1; node < num_nodes; node++) {
+                group.run([&exchange, node] { exchange(node); });
+            }
+            exchange(0);
+            group.wait();
+        } else {
+            for (size_t node = 0; node < num_nodes; node++) {
+                exchange(node);
+            }
+        }
+        for (size_t node = 0; node < num_nodes; node++) {
+            if (!ok[node]) {
+                return setError(error, "node " + to_string(node) + ": " + errors[node]);
+            }
+        }
+        return true;
+    }
+    
+    static string failureText(const vector<uint8_t>& reply) {
+        TileCodec::Reader in(reply);
+        TileCodec::Message type;
+        uint32_t length;
+        if (!in.header(type) || type != TileCodec::FAILURE || !in.get(length) || length > in.remaining()) {
+            return "unexpected reply";
+        }
+        string text(length, '\0');
+        in.getArray(&text[0], length);
+        return text;
+    }
+};
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+private:
+    const unsigned char* bytes;
+    size_t length;
+#ifdef _WIN32
+    HANDLE file_handle;
+    HANDLE mapping_handle;
+#endif
+    
+public:
+    MappedFile() : bytes(nullptr), length(0) {
+#ifdef _WIN32
+        file_handle = INVALID_HANDLE_VALUE;
+        mapping_handle = nullptr;
+#endif
+    }
+    
+    ~MappedFile() { close(); }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool open(const string& path, string* error = nullptr) {
+        close();
+#ifdef _WIN32
+        file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_handle == INVALID_HANDLE_VALUE) {
+            return setError(error, "cannot open " + path);
+        }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file_handle, &file_size)) {
+            close();
+            return setError(error, "cannot stat " + path);
+        }
+        length = static_cast<size_t>(file_size.QuadPart);
+        if (length > 0) {
+            mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            void* view = mapping_handle ? MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (!view) {
+                close();
+                return setError(error, "cannot map " + path);
+            }
+            bytes = static_cast<const unsigned char*>(view);
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return setError(error, "cannot open " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            return setError(error, "cannot stat " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view == MAP_FAILED) {
+                ::close(fd);
+                length = 0;
+                return setError(error, "cannot map " + path);
+            }
+            bytes = static_cast<const unsigned char*>(view);
+        }
+        ::close(fd);  // The mapping keeps the file alive
+#endif
+        return true;
+    }
+    
+    void close() {
+#ifdef _WIN32
+        if (bytes) {
+            UnmapViewOfFile(bytes);
+        }
+        if (mapping_handle) {
+            CloseHandle(mapping_handle);
+            mapping_handle = nullptr;
+        }
+        if (file_handle != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_handle);
+            file_handle = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (bytes) {
+            munmap(const_cast<unsigned char*>(bytes), length);
+        }
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+    
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+// Fixed-layout binary station catalog. A 128-byte header is followed by one
+// column per SeismicStation field, each starting on a 64-byte boundary, so a
+// mapped file can be viewed as a StationSet without parsing or copying.
+// All values are little-endian.
+struct CatalogHeader {
+    char magic[8];                 // "EQCATLG" + NUL
+    uint32_t version;
+    uint32_t byte_order;           // BYTE_ORDER_MARK as written by the producer
+    uint64_t header_size;
+    uint64_t station_count;
+    uint64_t latitude_offset;      // Byte offsets from the start of the file
+    uint64_t longitude_offset;
+    uint64_t time_offset;
+    uint64_t id_offset;
+    double min_lat, max_lat;       // Bounding box of the stations
+    double min_lon, max_lon;
+    uint8_t reserved[32];
+    
+    static const uint32_t CURRENT_VERSION = 1;
+    static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static const size_t COLUMN_ALIGNMENT = 64;
+};
+
+static_assert(sizeof(CatalogHeader) == 128, "catalog header layout changed");
+
+// Layout rules shared by the mapped formats: the catalog, the travel-time
+// grid, network snapshots and result files. Their headers all start with
+// the same magic, version, byte order and header size fields, and every
+// section starts on a CatalogHeader::COLUMN_ALIGNMENT boundary.
+
+static uint64_t alignTo(uint64_t offset, uint64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// True if count elements of element_size at offset lie past the header,
+// inside the file and on a column boundary
+static bool sectionFits(uint64_t file_size, uint64_t header_size, uint64_t offset, uint64_t count,
+                        uint64_t element_size) {
+    return offset % CatalogHeader::COLUMN_ALIGNMENT == 0 && offset >= header_size &&
+           offset <= file_size && count <= (file_size - offset) / element_size;
+}
+
+// Validates the common prologue of a Header at the start of file; returns
+// the header, or nullptr and sets error. kind names the format in messages.
+template <typename Header>
+static const Header* mappedHeader(const MappedFile& file, const string& path, const char* magic,
+                                  uint32_t version, const char* kind, string* error) {
+    if (file.size() < sizeof(Header)) {
+        setError(error, path + ": too small for a " + kind + " header");
+        return nullptr;
+    }
+    const Header* header = reinterpret_cast<const Header*>(file.data());
+    if (memcmp(header->magic, magic, sizeof(header->magic)) != 0) {
+        setError(error, path + ": not a " + kind);
+        return nullptr;
+    }
+    if (header->byte_order != CatalogHeader::BYTE_ORDER_MARK) {
+        setError(error, path + ": written with a different byte order");
+        return nullptr;
+    }
+    if (header->version != version) {
+        setError(error, path + ": unsupported " + kind + " version " + to_string(header->version));
+        return nullptr;
+    }
+    if (header->header_size != sizeof(Header)) {
+        setError(error, path + ": unexpected header size");
+        return nullptr;
+    }
+    return header;
+}
+
+class StationCatalog {
+private:
+    MappedFile file;
+    const CatalogHeader* header;
+    
+public:
+    StationCatalog() : header(nullptr) {}
+    
+    // Maps and validates a catalog; on failure returns false and sets error
+    bool open(const string& path, string* error = nullptr) {
+        header = nullptr;
+        if (!file.open(path, error)) {
+            return false;
+        }
+        const CatalogHeader* candidate = mappedHeader<CatalogHeader>(
+            file, path, "EQCATLG", CatalogHeader::CURRENT_VERSION, "station catalog", error);
+        if (!candidate) {
+            return false;
+        }
+        
+        uint64_t n = candidate->station_count;
+        bool columns_ok = columnFits(candidate->latitude_offset, n, sizeof(double)) &&
+                          columnFits(candidate->longitude_offset, n, sizeof(double)) &&
+                          columnFits(candidate->time_offset, n, sizeof(double)) &&
+                          columnFits(candidate->id_offset, n, sizeof(int32_t));
+        if (!columns_ok) {
+            return setError(error, path + ": column outside the file or misaligned");
+        }
+        header = candidate;
+        return true;
+    }
+    
+    bool isOpen() const { return header != nullptr; }
+    size_t size() const { return header ? static_cast<size_t>(header->station_count) : 0; }
+    
+    GeoBounds bounds() const {
+        return GeoBounds(header->min_lat, header->max_lat, header->min_lon, header->max_lon);
+    }
+    
+    // Zero-copy view of the mapped columns; valid while the catalog is open
+    StationSetView view() const {
+        if (!header) {
+            return StationSetView();
+        }
+        return StationSetView(column<double>(header->latitude_offset),
+                              column<double>(header->longitude_offset),
+                              column<double>(header->time_offset),
+                              column<int>(header->id_offset), size());
+    }
+    
+    static bool write(const string& path, const StationSetView& stations, string* error = nullptr) {
+        CatalogHeader out;
+        memset(&out, 0, sizeof(out));
+        memcpy(out.magic, "EQCATLG", 8);
+        out.version = CatalogHeader::CURRENT_VERSION;
+        out.byte_order = CatalogHeader::BYTE_ORDER_MARK;
+        out.header_size = sizeof(CatalogHeader);
+        out.station_count = stations.size();
+        
+        uint64_t offset = sizeof(CatalogHeader);
+        out.latitude_offset = offset;
+        offset = alignTo(offset + stations.size() * sizeof(double), CatalogHeader::COLUMN_ALIGNMENT);
+        out.longitude_offset = offset;
+        offset = alignTo(offset + stations.size() * sizeof(double), CatalogHeader::COLUMN_ALIGNMENT);
+        out.time_offset = offset;
+        offset = alignTo(offset + stations.size() * sizeof(double), CatalogHeader::COLUMN_ALIGNMENT);
+        out.id_offset = offset;
+        
+        out.min_lat = out.min_lon = numeric_limits<double>::infinity();
+        out.max_lat = out.max_lon = -numeric_limits<double>::infinity();
+        for (size_t i = 0; i < stations.size(); i++) {
+            out.min_lat = min(out.min_lat, stations.latitude[i]);
+            out.max_lat = max(out.max_lat, stations.latitude[i]);
+            out.min_lon = min(out.min_lon, stations.longitude[i]);
+            out.max_lon = max(out.max_lon, stations.longitude[i]);
+        }
+        
+        ofstream file(path, ios::binary | ios::trunc);
+        if (!file) {
+            return setError(error, "cannot create " + path);
+        }
+        file.write(reinterpret_cast<const char*>(&out), sizeof(out));
+        writeColumn(file, out.latitude_offset, stations.latitude, stations.size());
+        writeColumn(file, out.longitude_offset, stations.longitude, stations.size());
+        writeColumn(file, out.time_offset, stations.detection_time, stations.size());
+        writeColumn(file, out.id_offset, stations.id, stations.size());
+        if (!file) {
+            return setError(error, "write to " + path + " failed");
+        }
+        return true;
+    }
+    
+    // Converts "id,latitude,longitude,detection_time" rows (optional header
+    // line) into a binary catalog
+    static bool convertCsv(const string& csv_path, const string& catalog_path, string* error = nullptr) {
+        ifstream csv(csv_path);
+        if (!csv) {
+            return setError(error, "cannot open " + csv_path);
+        }
+        
+        StationSet stations;
+        string line;
+        size_t line_number = 0;
+        while (getline(csv, line)) {
+            line_number++;
+            if (line.empty() || line == "\r") {
+                continue;
+            }
+            char* cursor = const_cast<char*>(line.c_str());
+            char* end = nullptr;
+            long id = strtol(cursor, &end, 10);
+            if (end == cursor) {
+                if (line_number == 1) {
+                    continue;  // Header row
+                }
+                return setError(error, csv_path + ":" + to_string(line_number) + ": bad station id");
+            }
+            double fields[3];
+            for (double& field : fields) {
+                if (*end != ',') {
+                    return setError(error, csv_path + ":" + to_string(line_number) + ": expected 4 columns");
+                }
+                cursor = end + 1;
+                field = strtod(cursor, &end);
+                if (end == cursor) {
+                    return setError(error, csv_path + ":" + to_string(line_number) + ": bad number");
+                }
+            }
+            stations.push_back(SeismicStation(static_cast<int>(id), fields[0], fields[1], fields[2]));
+        }
+        return write(catalog_path, stations.view(), error);
+    }
+    
+private:
+    template <typename T>
+    const T* column(uint64_t offset) const {
+        return reinterpret_cast<const T*>(file.data() + offset);
+    }
+    
+    bool columnFits(uint64_t offset, uint64_t count, uint64_t element_size) const {
+        return sectionFits(file.size(), sizeof(CatalogHeader), offset, count, element_size);
+    }
+    
+    template <typename T>
+    static void writeColumn(ofstream& file, uint64_t offset, const T* values, size_t count) {
+        static const char padding[CatalogHeader::COLUMN_ALIGNMENT] = {};
+        uint64_t position = static_cast<uint64_t>(file.tellp());
+        file.write(padding, static_cast<streamsize>(offset - position));
+        file.write(reinterpret_cast<const char*>(values), static_cast<streamsize>(count * sizeof(T)));
+    }
+};
+
+// Binary travel-time grid: a 128-byte header followed by the rows x cols
+// table of doubles, row-major, on a 64-byte boundary. Little-endian.
+struct TravelTimeGridHeader {
+    char magic[8];                 // "EQTTGRD" + NUL
+    uint32_t version;
+    uint32_t byte_order;           // CatalogHeader::BYTE_ORDER_MARK as written
+    uint64_t header_size;
+    uint64_t rows;
+    uint64_t cols;
+    double step_lat;               // Degrees between rows
+    double step_lon;               // Degrees between columns
+    uint64_t data_offset;
+    uint8_t reserved[64];
+    
+    static const uint32_t CURRENT_VERSION = 1;
+};
+
+static_assert(sizeof(TravelTimeGridHeader) == 128, "travel-time grid header layout changed");
+
+// Owns a TravelTimeTable, either built in memory from a velocity model or
+// mapped read-only from a file written by write(). Point
+// LocatorConfig::travel_times at table() to use it.
+class TravelTimeGrid {
+private:
+    MappedFile file;
+    AlignedVector<double> owned;
+    TravelTimeTable lookup;
+    double step_lat, step_lon;
+    
+public:
+    // The SIMD kernels gather with 32-bit cell indices
+    static const size_t MAX_ENTRIES = (size_t(1) << 31) - 1;
+    
+    TravelTimeGrid() : lookup{nullptr, 0, 0, 0, 0}, step_lat(0), step_lon(0) {}
+    
+    TravelTimeGrid(const TravelTimeGrid&) = delete;
+    TravelTimeGrid& operator=(const TravelTimeGrid&) = delete;
+    
+    // Samples travel_time(delta_lat, delta_lon) on rows x cols offsets
+    // spanning the extent of root, the largest offset within it
+    template <typename Model>
+    bool build(const GeoBounds& root, size_t rows, size_t cols, Model travel_time,
+               string* error = nullptr) {
+        if (rows < 2 || cols < 2 || rows > MAX_ENTRIES / cols) {
+            return setError(error, "travel-time grid needs 2 to 2^31 entries in at least 2 rows and columns");
+        }
+        file.close();
+        double lat_step = (root.max_lat - root.min_lat) / (rows - 1);
+        double lon_step = (root.max_lon - root.min_lon) / (cols - 1);
+        owned.resize(rows * cols);
+        for (size_t i = 0; i < rows; i++) {
+            for (size_t j = 0; j < cols; j++) {
+                owned[i * cols + j] = travel_time(i * lat_step, j * lon_step);
+            }
+        }
+        attach(owned.data(), rows, cols, lat_step, lon_step);
+        return true;
+    }
+    
+    // The straight-ray model of the analytic residuals
+    bool buildStraightRay(const GeoBounds& root, size_t rows, size_t cols, double velocity,
+                          string* error = nullptr) {
+        return build(root, rows, cols, [velocity](double delta_lat, double delta_lon) {
+            return sqrt(delta_lat * delta_lat + delta_lon * delta_lon) / velocity;
+        }, error);
+    }
+    
+    // Maps and validates a grid file; on failure returns false and sets error
+    bool open(const string& path, string* error = nullptr) {
+        owned.clear();
+        lookup = TravelTimeTable{nullptr, 0, 0, 0, 0};
+        if (!file.open(path, error)) {
+            return false;
+        }
+        const TravelTimeGridHeader* header = mappedHeader<TravelTimeGridHeader>(
+            file, path, "EQTTGRD", TravelTimeGridHeader::CURRENT_VERSION, "travel-time grid", error);
+        if (!header) {
+            return false;
+        }
+        uint64_t rows = header->rows, cols = header->cols;
+        if (rows < 2 || cols < 2 || rows > MAX_ENTRIES / cols) {
+            return setError(error, path + ": unsupported grid dimensions");
+        }
+        uint64_t offset = header->data_offset;
+        if (!sectionFits(file.size(), sizeof(TravelTimeGridHeader), offset, rows * cols, sizeof(double))) {
+            return setError(error, path + ": table outside the file or misaligned");
+        }
+        if (!(header->step_lat >= 0) || !(header->step_lon >= 0)) {
+            return setError(error, path + ": bad grid spacing");
+        }
+        attach(reinterpret_cast<const double*>(file.data() + offset), rows, cols,
+               header->step_lat, header->step_lon);
+        return true;
+    }
+    
+    bool write(const string& path, string* error = nullptr) const {
+        if (!lookup.times) {
+            return setError(error, "travel-time grid is empty");
+        }
+        TravelTimeGridHeader out;
+        memset(&out, 0, sizeof(out));
+        memcpy(out.magic, "EQTTGRD", 8);
+        out.version = TravelTimeGridHeader::CURRENT_VERSION;
+        out.byte_order = CatalogHeader::BYTE_ORDER_MARK;
+        out.header_size = sizeof(TravelTimeGridHeader);
+        out.rows = lookup.rows;
+        out.cols = lookup.cols;
+        out.step_lat = step_lat;
+        out.step_lon = step_lon;
+        out.data_offset = sizeof(TravelTimeGridHeader);  // Already 64-byte aligned
+        
+        ofstream stream(path, ios::binary | ios::trunc);
+        if (!stream) {
+            return setError(error, "cannot create " + path);
+        }
+        stream.write(reinterpret_cast<const char*>(&out), sizeof(out));
+        stream.write(reinterpret_cast<const char*>(lookup.times),
+                     static_cast<streamsize>(lookup.rows * lookup.cols * sizeof(double)));
+        if (!stream) {
+            return setError(error, "write to " + path + " failed");
+        }
+        return true;
+    }
+    
+    bool empty() const { return lookup.times == nullptr; }
+    size_t rows() const { return lookup.rows; }
+    size_t cols() const { return lookup.cols; }
+    
+    // Valid while the grid is alive and not rebuilt or reopened
+    const TravelTimeTable& table() const { return lookup; }
+    
+private:
+    void attach(const double* times, size_t rows, size_t cols, double lat_step, double lon_step) {
+        step_lat = lat_step;
+        step_lon = lon_step;
+        // A zero extent collapses that axis onto its first row or column
+        lookup = TravelTimeTable{times, rows, cols, lat_step > 0 ? 1.0 / lat_step : 0.0,
+                                 lon_step > 0 ? 1.0 / lon_step : 0.0};
+    }
+};
+
+// Snapshot of a built StationNetwork, so a restart can skip the quadtree
+// build. A 128-byte header is followed by one 64-byte record per node, then
+// the latitude, longitude and id columns in leaf order, each on a 64-byte
+// boundary. Offsets count from the start of the file, so the file can be
+// mapped anywhere. The checksum covers everything after the header. All
+// values are little-endian.
+struct SnapshotHeader {
+    char magic[8];                 // "EQNETSN" + NUL
+    uint32_t version;
+    uint32_t byte_order;           // CatalogHeader::BYTE_ORDER_MARK as written
+    uint64_t header_size;
+    uint64_t network_version;      // Caller's revision of the station network
+    uint64_t node_count;
+    uint64_t station_count;
+    uint64_t max_leaf_size;
+    uint64_t nodes_offset;         // Byte offsets from the start of the file
+    uint64_t latitude_offset;
+    uint64_t longitude_offset;
+    uint64_t id_offset;
+    uint64_t file_size;
+    uint64_t checksum;             // NetworkSnapshot::checksum of the bytes after the header
+    uint8_t reserved[24];
+    
+    static constexpr uint32_t CURRENT_VERSION = 1;
+};
+
+// StationNetwork::Node with explicit padding, so the bytes are deterministic
+struct SnapshotNode {
+    double bounds[4];              // min_lat, max_lat, min_lon, max_lon
+    uint32_t first;
+    uint32_t count;
+    int32_t children[4];           // Absolute node index, -1 = none
+    int32_t depth;
+    uint32_t leaf;
+};
+
+static_assert(sizeof(SnapshotHeader) == 128, "snapshot header layout changed");
+static_assert(sizeof(SnapshotNode) == 64, "snapshot node layout changed");
+
+// Writes and restores network snapshots. open() maps the file, checks the
+// header, the network version the caller expects and the checksum, then
+// loads the network with one copy per column; nothing is partitioned or
+// sorted again.
+class NetworkSnapshot {
+private:
+    StationNetwork restored;
+    uint64_t network_version;
+    bool loaded;
+    
+public:
+    NetworkSnapshot() : network_version(0), loaded(false) {}
+    
+    bool open(const string& path, uint64_t expected_version, string* error = nullptr) {
+        loaded = false;
+        MappedFile file;
+        if (!file.open(path, error)) {
+            return false;
+        }
+        const SnapshotHeader* header = mappedHeader<SnapshotHeader>(
+            file, path, "EQNETSN", SnapshotHeader::CURRENT_VERSION, "network snapshot", error);
+        if (!header) {
+            return false;
+        }
+        if (header->file_size != file.size()) {
+            return setError(error, path + ": truncated file");
+        }
+        if (header->network_version != expected_version) {
+            return setError(error, path + ": snapshot of network version " + to_string(header->network_version) +
+                               ", expected " + to_string(expected_version));
+        }
+        uint64_t nodes = header->node_count, stations = header->station_count;
+        bool sections_ok = nodes > 0 && nodes <= UINT32_MAX && stations <= UINT32_MAX &&
+                           sectionFits(file.size(), sizeof(SnapshotHeader), header->nodes_offset, nodes,
+                                       sizeof(SnapshotNode)) &&
+                           sectionFits(file.size(), sizeof(SnapshotHeader), header->latitude_offset, stations,
+                                       sizeof(double)) &&
+                           sectionFits(file.size(), sizeof(SnapshotHeader), header->longitude_offset, stations,
+                                       sizeof(double)) &&
+                           sectionFits(file.size(), sizeof(SnapshotHeader), header->id_offset, stations,
+                                       sizeof(int32_t));
+        if (!sections_ok) {
+            return setError(error, path + ": section outside the file or misaligned");
+        }
+        if (checksum(file.data() + sizeof(SnapshotHeader), file.size() - sizeof(SnapshotHeader)) != 
+            header->checksum) {
+            return setError(error, path + ": checksum mismatch");
+        }
+        
+        // Same structural checks as a network read off the wire. The leaf
+        // tile of the batch paths is sized by max_leaf_size, so it is derived
+        // from the leaves and must agree with the header, which the checksum
+        // does not cover.
+        const SnapshotNode* records = reinterpret_cast<const SnapshotNode*>(file.data() + header->nodes_offset);
+        restored.nodes.clear();
+        restored.nodes.reserve(nodes);
+        restored.build_generation = StationNetwork::nextGeneration();
+        size_t max_leaf_size = 0;
+        for (uint64_t k = 0; k < nodes; k++) {
+            const SnapshotNode& record = records[k];
+            const double* b = record.bounds;
+            StationNetwork::Node node(GeoBounds(b[0], b[1], b[2], b[3]));
+            node.first = record.first;
+            node.count = record.count;
+            node.depth = record.depth;
+            node.leaf = record.leaf != 0;
+            for (int q = 0; q < 4; q++) {
+                int32_t child = record.children[q];
+                if (child != -1 && (child <= static_cast<int64_t>(k) || uint64_t(child) >= nodes)) {
+                    return setError(error, path + ": node " + to_string(k) + " has a bad child");
+                }
+                node.children[q] = child;
+            }
+            if (uint64_t(node.first) + node.count > stations) {
+                return setError(error, path + ": node " + to_string(k) + " outside the station columns");
+            }
+            if (node.leaf) {
+                max_leaf_size = max(max_leaf_size, static_cast<size_t>(node.count));
+            }
+            restored.nodes.push_back(node);
+        }
+        if (restored.nodes[0].count != stations) {
+            return setError(error, path + ": root does not cover every station");
+        }
+        if (!restored.depthsFollowTree(0)) {
+            return setError(error, path + ": node depths do not match the tree");
+        }
+        if (header->max_leaf_size != max_leaf_size) {
+            return setError(error, path + ": max leaf size does not match the leaves");
+        }
+        
+        size_t n = static_cast<size_t>(stations);
+        auto load = [&](auto& column, uint64_t offset) {
+            column.resize(n);
+            if (n > 0) {
+                memcpy(column.data(), file.data() + offset, n * sizeof(column[0]));
+            }
+        };
+        load(restored.latitude, header->latitude_offset);
+        load(restored.longitude, header->longitude_offset);
+        load(restored.station_id, header->id_offset);
+        restored.max_leaf_size = max_leaf_size;
+        network_version = header->network_version;
+        loaded = true;
+        return true;
+    }
+    
+    bool isOpen() const { return loaded; }
+    uint64_t networkVersion() const { return network_version; }
+    
+    // The restored network; valid while the snapshot object lives. Move it
+    // out to keep it longer.
+    StationNetwork& network() { return restored; }
+    
+    static bool write(const string& path, const StationNetwork& network, uint64_t network_version, 
+                      string* error = nullptr) {
+        SnapshotHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "EQNETSN", 8);
+        header.version = SnapshotHeader::CURRENT_VERSION;
+        header.byte_order = CatalogHeader::BYTE_ORDER_MARK;
+        header.header_size = sizeof(SnapshotHeader);
+        header.network_version = network_version;
+        header.node_count = network.nodes.size();
+        header.station_count = network.size();
+        header.max_leaf_size = network.max_leaf_size;
+        
+        // The body is assembled in memory so the checksum covers exactly the written bytes
+        uint64_t n = network.size();
+        header.nodes_offset = sizeof(SnapshotHeader);
+        uint64_t a = CatalogHeader::COLUMN_ALIGNMENT;
+        header.latitude_offset = alignTo(header.nodes_offset + header.node_count * sizeof(SnapshotNode), a);
+        header.longitude_offset = alignTo(header.latitude_offset + n * sizeof(double), a);
+        header.id_offset = alignTo(header.longitude_offset + n * sizeof(double), a);
+        header.file_size = header.id_offset + n * sizeof(int32_t);
+        
+        vector<unsigned char> body(static_cast<size_t>(header.file_size - sizeof(SnapshotHeader)), 0);
+        auto at = [&](uint64_t offset) { return body.data() + (offset - sizeof(SnapshotHeader)); };
+        for (size_t k = 0; k < network.nodes.size(); k++) {
+            const StationNetwork::Node& node = network.nodes[k];
+            SnapshotNode record;
+            memset(&record, 0, sizeof(record));
+            record.bounds[0] = node.bounds.min_lat;
+            record.bounds[1] = node.bounds.max_lat;
+            record.bounds[2] = node.bounds.min_lon;
+            record.bounds[3] = node.bounds.max_lon;
+            record.first = node.first;
+            record.count = node.count;
+            copy(node.children, node.children + 4, record.children);
+            record.depth = node.depth;
+            record.leaf = node.leaf ? 1 : 0;
+            memcpy(at(header.nodes_offset) + k * sizeof(SnapshotNode), &record, sizeof(record));
+        }
+        if (n > 0) {
+            memcpy(at(header.latitude_offset), network.latitude.data(), n * sizeof(double));
+            memcpy(at(header.longitude_offset), network.longitude.data(), n * sizeof(double));
+            memcpy(at(header.id_offset), network.station_id.data(), n * sizeof(int32_t));
+        }
+        header.checksum = checksum(body.data(), body.size());
+        
+        ofstream file(path, ios::binary | ios::trunc);
+        if (!file) {
+            return setError(error, "cannot create " + path);
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(body.data()), static_cast<streamsize>(body.size()));
+        if (!file) {
+            return setError(error, "write to " + path + " failed");
+        }
+        return true;
+    }
+    
+    // 64-bit corruption check (not cryptographic): four multiply-rotate
+    // lanes over 8-byte words, so it runs at memory speed, then a splitmix
+    // finaliser over the lanes and the length
+    static uint64_t checksum(const unsigned char* data, size_t size) {
+        const uint64_t PRIME = 0x9E3779B97F4A7C15ULL;
+        uint64_t lanes[4] = {0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL, 
+                             0xA4093822299F31D0ULL, 0x082EFA98EC4E6C89ULL};
+        auto rotate = [](uint64_t x) { return (x << 29) | (x >> 35); };
+        size_t words = size / 8;
+        size_t i = 0;
+        for (; i + 4 <= words; i += 4) {
+            for (int l = 0; l < 4; l++) {
+                uint64_t word;
+                memcpy(&word, data + (i + l) * 8, 8);
+                lanes[l] = rotate(lanes[l] ^ word) * PRIME;
+            }
+        }
+        for (; i < words; i++) {
+            uint64_t word;
+            memcpy(&word, data + i * 8, 8);
+            lanes[i % 4] = rotate(lanes[i % 4] ^ word) * PRIME;
+        }
+        uint64_t tail = 0;
+        memcpy(&tail, data + words * 8, size % 8);
+        uint64_t hash = size;
+        for (uint64_t lane : lanes) {
+            hash = mix(hash ^ lane);
+        }
+        return mix(hash ^ tail);
+    }
+    
+private:
+    static uint64_t mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+};
+
+// Destination for located events. Results are numbered consecutively in the
+// order they are written; close() writes out whatever is buffered and
+// reports the first error.
+class ResultSink {
+public:
+    virtual ~ResultSink() {}
+    
+    virtual bool write(Span<const EpicenterResult> results, string* error = nullptr) = 0;
+    virtual bool close(string* error = nullptr) = 0;
+};
+
+// "event,latitude,longitude,confidence,error" rows through a CsvWriter
+class CsvResultSink : public ResultSink {
+private:
+    ofstream file;
+    unique_ptr<CsvWriter> csv;
+    uint64_t next_event;
+    string path;
+    
+public:
+    CsvResultSink() : next_event(0) {}
+    ~CsvResultSink() override { close(); }
+    
+    bool open(const string& _path, string* error = nullptr) {
+        close();
+        path = _path;
+        next_event = 0;
+        file.open(path, ios::binary | ios::trunc);
+        if (!file) {
+            return setError(error, "cannot create " + path);
+        }
+        csv.reset(new CsvWriter(file));
+        csv->field("event").field("latitude").field("longitude").field("confidence").field("error");
+        csv->endRow();
+        return true;
+    }
+    
+    bool write(Span<const EpicenterResult> results, string* error = nullptr) override {
+        if (!csv) {
+            return setError(error, "result sink is not open");
+        }
+        for (const EpicenterResult& r : results) {
+            csv->field(next_event++).field(r.location.x).field(r.location.y)
+                .field(r.confidence).field(r.error);
+            csv->endRow();
+        }
+        if (!file) {
+            return setError(error, "write to " + path + " failed");
+        }
+        return true;
+    }
+    
+    bool close(string* error = nullptr) override {
+        if (!csv) {
+            return true;
+        }
+        bool ok = csv->flush();
+        csv.reset();
+        file.close();
+        return ok || setError(error, "write to " + path + " failed");
+    }
+};
+
+// Binary columnar result file: a 64-byte header, then batches of
+// batch_rows results (the last one may be short). A batch stores its
+// latitude, longitude, confidence and error columns as doubles, each on a
+// 64-byte boundary, so a mapped file can be read a column at a time
+// without parsing; batch b starts at header_size + b * batchStride().
+// All values are little-endian.
+struct ResultFileHeader {
+    char magic[8];                 // "EQRSLTS" + NUL
+    uint32_t version;
+    uint32_t byte_order;           // CatalogHeader::BYTE_ORDER_MARK as written
+    uint64_t header_size;
+    uint64_t row_count;
+    uint64_t batch_rows;
+    uint8_t reserved[24];
+    
+    static constexpr uint32_t CURRENT_VERSION = 1;
+    static constexpr size_t NUM_COLUMNS = 4;
+    
+    // Bytes of one column of a batch with the given number of rows
+    static uint64_t columnStride(uint64_t rows) {
+        return alignTo(rows * sizeof(double), CatalogHeader::COLUMN_ALIGNMENT);
+    }
+    
+    uint64_t batchStride() const { return NUM_COLUMNS * columnStride(batch_rows); }
+};
+
+static_assert(sizeof(ResultFileHeader) == 64, "result file header layout changed");
+
+// Writes a result file. Results are transposed into the current batch's
+// columns, and each full batch goes to the file in four writes. The header
+// is rewritten with the final row count at close(), so a file that was not
+// closed reads as empty.
+class ColumnarResultSink : public ResultSink {
+private:
+    ofstream file;
+    ResultFileHeader header;
+    vector<double> columns[ResultFileHeader::NUM_COLUMNS];
+    size_t pending;
+    string path;
+    
+public:
+    ColumnarResultSink() : pending(0) { memset(&header, 0, sizeof(header)); }
+    ~ColumnarResultSink() override { close(); }
+    
+    bool open(const string& _path, size_t batch_rows = 65536, string* error = nullptr) {
+        close();
+        path = _path;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "EQRSLTS", 8);
+        header.version = ResultFileHeader::CURRENT_VERSION;
+        header.byte_order = CatalogHeader::BYTE_ORDER_MARK;
+        header.header_size = sizeof(ResultFileHeader);
+        header.batch_rows = max(batch_rows, size_t(1));
+        for (vector<double>& column : columns) {
+            column.assign(header.batch_rows, 0.0);
+        }
+        pending = 0;
+        
+        file.open(path, ios::binary | ios::trunc);
+        if (!file) {
+            return setError(error, "cannot create " + path);
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        return file || setError(error, "write to " + path + " failed");
+    }
+    
+    bool write(Span<const EpicenterResult> results, string* error = nullptr) override {
+        if (!file.is_open()) {
+            return setError(error, "result sink is not open");
+        }
+        size_t done = 0;
+        while (done < results.size()) {
+            size_t take = min(results.size() - done, static_cast<size_t>(header.batch_rows) - pending);
+            for (size_t i = 0; i < take; i++) {
+                const EpicenterResult& r = results[done + i];
+                columns[0][pending + i] = r.location.x;
+                columns[1][pending + i] = r.location.y;
+                columns[2][pending + i] = r.confidence;
+                columns[3][pending + i] = r.error;
+            }
+            pending += take;
+            done += take;
+            if (pending == header.batch_rows) {
+                writeBatch();
+            }
+        }
+        return file || setError(error, "write to " + path + " failed");
+    }
+    
+    bool close(string* error = nullptr) override {
+        if (!file.is_open()) {
+            return true;
+        }
+        if (pending > 0) {
+            writeBatch();
+        }
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        bool ok = static_cast<bool>(file);
+        file.close();
+        return ok || setError(error, "write to " + path + " failed");
+    }
+    
+private:
+    void writeBatch() {
+        static const char padding[CatalogHeader::COLUMN_ALIGNMENT] = {};
+        uint64_t bytes = pending * sizeof(double);
+        uint64_t stride = ResultFileHeader::columnStride(pending);
+        for (const vector<double>& column : columns) {
+            file.write(reinterpret_cast<const char*>(column.data()), static_cast<streamsize>(bytes));
+            file.write(padding, static_cast<streamsize>(stride - bytes));
+        }
+        header.row_count += pending;
+        pending = 0;
+    }
+};
+
+// Read side of a result file: maps it and hands out zero-copy column views
+class ResultFile {
+public:
+    struct Batch {
+        const double* latitude;
+        const double* longitude;
+        const double* confidence;
+        const double* error;
+        size_t rows;
+    };
+    
+private:
+    MappedFile file;
+    const ResultFileHeader* header;
+    
+public:
+    ResultFile() : header(nullptr) {}
+    
+    bool open(const string& path, string* error = nullptr) {
+        header = nullptr;
+        if (!file.open(path, error)) {
+            return false;
+        }
+        const ResultFileHeader* candidate = mappedHeader<ResultFileHeader>(
+            file, path, "EQRSLTS", ResultFileHeader::CURRENT_VERSION, "result file", error);
+        if (!candidate) {
+            return false;
+        }
+        if (candidate->batch_rows == 0) {
+            return setError(error, path + ": bad header");
+        }
+        // Every batch before the last is full; the last one holds the rest
+        uint64_t rows = candidate->row_count;
+        uint64_t batches = (rows + candidate->batch_rows - 1) / candidate->batch_rows;
+        uint64_t need = sizeof(ResultFileHeader);
+        if (batches > 0) {
+            uint64_t full = batches - 1;
+            if (full > (file.size() - need) / candidate->batchStride()) {
+                return setError(error, path + ": truncated");
+            }
+            need += full * candidate->batchStride();
+            uint64_t last_rows = rows - full * candidate->batch_rows;
+            if (ResultFileHeader::NUM_COLUMNS * ResultFileHeader::columnStride(last_rows) > file.size() - need) {
+                return setError(error, path + ": truncated");
+            }
+        }
+        header = candidate;
+        return true;
+    }
+    
+    bool isOpen() const { return header != nullptr; }
+    size_t size() const { return header ? static_cast<size_t>(header->row_count) : 0; }
+    
+    size_t batchCount() const {
+        return header ? static_cast<size_t>((header->row_count + header->batch_rows - 1) / header->batch_rows) : 0;
+    }
+    
+    // Valid while the file is open
+    Batch batch(size_t b) const {
+        uint64_t first = b * header->batch_rows;
+        uint64_t rows = min(header->batch_rows, header->row_count - first);
+        uint64_t stride = ResultFileHeader::columnStride(rows);
+        const unsigned char* base = file.data() + header->header_size + b * header->batchStride();
+        const double* column = reinterpret_cast<const double*>(base);
+        size_t step = static_cast<size_t>(stride / sizeof(double));
+        return Batch{column, column + step, column + 2 * step, column + 3 * step, static_cast<size_t>(rows)};
+    }
+    
+    EpicenterResult operator[](size_t i) const {
+        Batch rows = batch(static_cast<size_t>(i / header->batch_rows));
+        size_t k = static_cast<size_t>(i % header->batch_rows);
+        return EpicenterResult(Point(rows.latitude[k], rows.longitude[k]), rows.confidence[k], rows.error[k]);
+    }
+};
+
+// Moves a sink's formatting and disk I/O onto a writer thread. write()
+// copies the results into a recycled buffer and queues it, so the locating
+// thread only waits if more than max_pending results are already queued
+// (counted in Stats::stalls). Batches reach the target in write() order.
+// After the target fails, later writes return its error and are dropped.
+class AsyncResultSink : public ResultSink {
+public:
+    struct Stats {
+        uint64_t batches;      // Batches handed to the target
+        uint64_t results;
+        uint64_t stalls;       // write() calls that waited for the writer
+    };
+    
+private:
+    ResultSink& target;
+    size_t max_pending;
+    
+    mutex lock;
+    condition_variable ready;      // Writer: work queued or closing
+    condition_variable drained;    // Producers: room in the queue
+    deque<vector<EpicenterResult>> queue;
+    vector<vector<EpicenterResult>> spare;
+    size_t pending;
+    bool closing;
+    bool failed;
+    string failure;
+    Stats counters;
+    thread writer;
+    
+public:
+    explicit AsyncResultSink(ResultSink& _target, size_t _max_pending = size_t(1) << 22)
+        : target(_target), max_pending(max(_max_pending, size_t(1))), pending(0),
+          closing(false), failed(false), counters{0, 0, 0} {
+        writer = thread([this] { run(); });
+    }
+    
+    ~AsyncResultSink() override { close(); }
+    
+    AsyncResultSink(const AsyncResultSink&) = delete;
+    AsyncResultSink& operator=(const AsyncResultSink&) = delete;
+    
+    bool write(Span<const EpicenterResult> results, string* error = nullptr) override {
+        if (results.empty()) {
+            return true;
+        }
+        unique_lock<mutex> guard(lock);
+        if (failed || closing) {
+            return setError(error, failed ? failure : "result sink is closed");
+        }
+        if (pending > 0 && pending + results.size() > max_pending) {
+            counters.stalls++;
+            drained.wait(guard, [&] { return pending + results.size() <= max_pending || pending == 0 || failed; });
+            if (failed) {
+                return setError(error, failure);
+            }
+        }
+        vector<EpicenterResult> buffer;
+        if (!spare.empty()) {
+            buffer = std::move(spare.back());
+            spare.pop_back();
+        }
+        buffer.assign(results.begin(), results.end());
+        pending += buffer.size();
+        queue.push_back(std::move(buffer));
+        guard.unlock();
+        ready.notify_one();
+        return true;
+    }
+    
+    // Waits for the queue to drain, stops the writer and closes the target
+    bool close(string* error = nullptr) override {
+        {
+            lock_guard<mutex> guard(lock);
+            closing = true;
+        }
+        ready.notify_one();
+        if (writer.joinable()) {
+            writer.join();
+        }
+        string target_error;
+        bool closed = target.close(&target_error);
+        if (failed) {
+            return setError(error, failure);
+        }
+        return closed || setError(error, target_error);
+    }
+    
+    Stats stats() {
+        lock_guard<mutex> guard(lock);
+        return counters;
+    }
+    
+private:
+    void run() {
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            ready.wait(guard, [this] { return !queue.empty() || closing; });
+            if (queue.empty()) {
+                return;
+            }
+            vector<EpicenterResult> buffer = std::move(queue.front());
+            queue.pop_front();
+            bool skip = failed;
+            guard.unlock();
+            
+            string error;
+            bool ok = skip || target.write(Span<const EpicenterResult>(buffer), &error);
+            
+            guard.lock();
+            if (!ok) {
+                failed = true;
+                failure = error;
+            }
+            if (!skip) {
+                counters.batches++;
+                counters.results += buffer.size();
+            }
+            pending -= buffer.size();
+            buffer.clear();
+            spare.push_back(std::move(buffer));
+            drained.notify_all();
+        }
+    }
+};
+
+// Philox4x32-10 counter-based generator (Salmon et al., SC'11). Every
+// output block is a pure function of (counter, key), so any station or event
+// can be generated independently, in any order, on any thread.
+struct Philox4x32 {
+    typedef array<uint32_t, 4> Block;
+    
+    static Block generate(Block counter, uint64_t seed) {
+        uint32_t key[2] = {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+        for (int round = 0; round < 10; round++) {
+            uint64_t p0 = uint64_t(0xD2511F53) * counter[0];
+            uint64_t p1 = uint64_t(0xCD9E8D57) * counter[2];
+            counter = {static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(p1),
+                       static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(p0)};
+            key[0] += 0x9E3779B9;
+            key[1] += 0xBB67AE85;
+        }
+        return counter;
+    }
+    
+    // Uniform in [0, 1) from 53 bits of two words
+    static double uniform(uint32_t high, uint32_t low) {
+        return static_cast<double>((uint64_t(high) << 32 | low) >> 11) * 0x1.0p-53;
+    }
+};
+
+// Shape of a synthetic deployment for load tests
+struct NetworkScenario {
+    size_t num_stations;
+    GeoBounds region;
+    
+    // Clustered layout: cluster_fraction of the stations are spread normally
+    // (cluster_radius degrees standard deviation) around num_clusters centers
+    // drawn uniformly in the region; the rest are uniform. 0 clusters = uniform.
+    size_t num_clusters;
+    double cluster_radius;
+    double cluster_fraction;
+    
+    // Events and picks: arrival = origin_time + distance / velocity + noise,
+    // noise uniform in [-pick_noise, pick_noise]. A station misses an event
+    // (NaN) with probability 1 - pick_probability.
+    vector<Point> epicenters;
+    vector<double> origin_times;  // Per event; missing entries are 0
+    double velocity;
+    double pick_noise;
+    double pick_probability;
+    
+    NetworkScenario(size_t n = 0, const GeoBounds& _region = GeoBounds(32.0, 42.0, -125.0, -114.0))
+        : num_stations(n), region(_region), num_clusters(0), cluster_radius(0.2), 
+          cluster_fraction(0.8), epicenters(1, Point(35.0, -120.0)),
+          velocity(EarthquakeEpicenterLocator::WAVE_VELOCITY), pick_noise(0.5), pick_probability(1.0) {}
+};
+
+// Reproducible synthetic networks. Output depends only on the scenario and
+// the seed, never on the thread count: station i, event e draws from Philox
+// counter (i, e, stream) with the seed as key. Work is split into chunks
+// written straight into preallocated SoA storage; with a pool the chunks run
+// in parallel. Station ids are 0..n-1.
+class SyntheticNetwork {
+public:
+    static const size_t CHUNK = 1 << 16;
+    
+    // Station positions, with event 0's picks as detection times. Every
+    // station detects here (the locators expect finite times); missed picks
+    // only apply to generateArrivals.
+    static void generate(const NetworkScenario& scenario, uint64_t seed, StationSet& out,
+                         WorkStealingPool* pool = nullptr) {
+        size_t n = scenario.num_stations;
+        out.resize(n);
+        vector<Point> centers = clusterCenters(scenario, seed);
+        forChunks(n, pool, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                Point position = stationPosition(scenario, seed, centers, i);
+                out.latitude[i] = position.x;
+                out.longitude[i] = position.y;
+                out.id[i] = static_cast<int>(i);
+                out.detection_time[i] = arrival(scenario, seed, 0, i, position, false);
+            }
+        });
+    }
+    
+    // Arrival vectors (by station id) of every scenario event over stations
+    // produced by generate with the same scenario and seed
+    static void generateArrivals(const NetworkScenario& scenario, uint64_t seed,
+                                 const StationSetView& stations, vector<ArrivalVector>& events,
+                                 WorkStealingPool* pool = nullptr) {
+        size_t n = stations.size();
+        events.resize(scenario.epicenters.size());
+        for (auto& arrivals : events) {
+            arrivals.assign(n, numeric_limits<double>::quiet_NaN());
+        }
+        forChunks(n, pool, [&](size_t begin, size_t end) {
+            for (size_t e = 0; e < events.size(); e++) {
+                for (size_t i = begin; i < end; i++) {
+                    Point position(stations.latitude[i], stations.longitude[i]);
+                    size_t id = static_cast<size_t>(stations.id[i]);
+                    if (id < n) {
+                        events[e][id] = arrival(scenario, seed, e, id, position, true);
+                    }
+                }
+            }
+        });
+    }
+    
+private:
+    enum Stream : uint32_t { POSITION, CLUSTER, PICK, CENTER };
+    
+    static Philox4x32::Block draw(uint64_t seed, size_t index, size_t event, Stream stream) {
+        return Philox4x32::generate({static_cast<uint32_t>(index), static_cast<uint32_t>(uint64_t(index) >> 32),
+                                     static_cast<uint32_t>(event), stream}, seed);
+    }
+    
+    static vector<Point> clusterCenters(const NetworkScenario& scenario, uint64_t seed) {
+        const GeoBounds& r = scenario.region;
+        vector<Point> centers;
+        for (size_t k = 0; k < scenario.num_clusters; k++) {
+            Philox4x32::Block b = draw(seed, k, 0, CENTER);
+            centers.push_back(Point(r.min_lat + (r.max_lat - r.min_lat) * Philox4x32::uniform(b[0], b[1]),
+                                    r.min_lon + (r.max_lon - r.min_lon) * Philox4x32::uniform(b[2], b[3])));
+        }
+        return centers;
+    }
+    
+    static Point stationPosition(const NetworkScenario& scenario, uint64_t seed,
+                                 const vector<Point>& centers, size_t i) {
+        const GeoBounds& r = scenario.region;
+        Philox4x32::Block b = draw(seed, i, 0, POSITION);
+        double u = Philox4x32::uniform(b[0], b[1]);
+        double v = Philox4x32::uniform(b[2], b[3]);
+        if (!centers.empty()) {
+            Philox4x32::Block c = draw(seed, i, 0, CLUSTER);
+            if (Philox4x32::uniform(c[0], c[1]) < scenario.cluster_fraction) {
+                // Box-Muller on (u, v); 1 - u stays in (0, 1]
+                const Point& center = centers[c[2] % centers.size()];
+                double radius = scenario.cluster_radius * sqrt(-2.0 * log(1.0 - u));
+                double angle = 2.0 * M_PI * v;
+                return Point(min(max(center.x + radius * cos(angle), r.min_lat), r.max_lat),
+                             min(max(center.y + radius * sin(angle), r.min_lon), r.max_lon));
+            }
+        }
+        return Point(r.min_lat + (r.max_lat - r.min_lat) * u, r.min_lon + (r.max_lon - r.min_lon) * v);
+    }
+    
+    static double arrival(const NetworkScenario& scenario, uint64_t seed, size_t event, size_t i,
+                          const Point& position, bool allow_miss) {
+        Philox4x32::Block b = draw(seed, i, event, PICK);
+        if (allow_miss && scenario.pick_probability < 1.0 && Philox4x32::uniform(b[2], b[3]) >= scenario.pick_probability) {
+            return numeric_limits<double>::quiet_NaN();
+        }
+        double origin = event < scenario.origin_times.size() ? scenario.origin_times[event] : 0.0;
+        double noise = (2.0 * Philox4x32::uniform(b[0], b[1]) - 1.0) * scenario.pick_noise;
+        return origin + scenario.epicenters[event].distance(position) / scenario.velocity + noise;
+    }
+    
+    template <typename Body>
+    static void forChunks(size_t n, WorkStealingPool* pool, Body body) {
+        if (!pool || n <= CHUNK) {
+            body(size_t(0), n);
+            return;
+        }
+        TaskGroup group(*pool);
+        for (size_t begin = 0; begin < n; begin += CHUNK) {
+            size_t end = min(begin + CHUNK, n);
+            group.run([&body, begin, end] { body(begin, end); });
+        }
+        group.wait();
+    }
+};
+
+// Long-running locate service for a feed of events. Any thread may submit an
+// event's arrivals; a fixed set of workers, each with its own locator and
+// ScratchArena, takes them from a lock-free MPMC queue. Every worker
+// publishes to its own lock-free SPSC ring, drained by one consumer thread
+// through pollResults. A full queue rejects submissions and a full ring
+// stalls its worker; both are counted, along with per-stage latency.
+class LocatorService {
+public:
+    struct Outcome {
+        uint64_t event_id;
+        EpicenterResult result;
+        double queue_us;      // Submit to picked up by a worker
+        double locate_us;     // locateEpicenter itself
+        double publish_us;    // Result ready to visible in the ring
+    };
+    
+    struct StageLatency {
+        uint64_t count;
+        double mean_us;
+        double max_us;
+    };
+    
+    struct Stats {
+        uint64_t submitted;
+        uint64_t rejected;        // submit() on a full queue or a stopped service
+        uint64_t completed;       // Results published
+        uint64_t delivered;       // Results returned by pollResults
+        uint64_t publish_stalls;  // Worker retries on a full result ring
+        uint64_t dropped;         // Results discarded at stop() on a full ring
+        size_t queue_depth;
+        StageLatency queue, locate, publish, delivery;
+    };
+    
+private:
+    struct Event {
+        uint64_t event_id;
+        vector<SeismicStation> stations;
+        GeoBounds bounds;
+        steady_clock::time_point submitted;
+    };
+    
+    struct Published {
+        Outcome outcome;
+        steady_clock::time_point published;
+    };
+    
+    // Lock-free latency accumulator
+    struct StageCounter {
+        atomic<uint64_t> count{0};
+        atomic<uint64_t> total_ns{0};
+        atomic<uint64_t> max_ns{0};
+        
+        void record(steady_clock::duration elapsed) {
+            uint64_t ns = static_cast<uint64_t>(duration_cast<nanoseconds>(elapsed).count());
+            count.fetch_add(1, memory_order_relaxed);
+            total_ns.fetch_add(ns, memory_order_relaxed);
+            uint64_t seen = max_ns.load(memory_order_relaxed);
+            while (ns > seen && !max_ns.compare_exchange_weak(seen, ns, memory_order_relaxed)) {}
+        }
+        
+        StageLatency snapshot() const {
+            uint64_t n = count.load(memory_order_relaxed);
+            double total = static_cast<double>(total_ns.load(memory_order_relaxed));
+            return {n, n ? total / n / 1000 : 0.0, max_ns.load(memory_order_relaxed) / 1000.0};
+        }
+    };
+    
+    struct Worker {
+        EarthquakeEpicenterLocator locator;
+        SpscRing<Published> results;
+        thread runner;
+        
+        Worker(const LocatorConfig& config, size_t ring_capacity) 
+            : locator(config), results(ring_capacity) {}
+    };
+    
+    MpmcQueue<Event> events;
+    vector<unique_ptr<Worker>> workers;
+    atomic<bool> closed;                 // submit() rejects from here on
+    atomic<size_t> submitting;           // submit() calls past the closed check
+    atomic<bool> stopping;               // Workers drain the queue and exit
+    size_t next_ring;                    // Consumer's round-robin start
+    
+    atomic<uint64_t> submitted, rejected, completed, delivered, publish_stalls, dropped;
+    StageCounter queue_latency, locate_latency, publish_latency, delivery_latency;
+    
+public:
+    // Workers run serial locates with config; use_arena is always enabled
+    LocatorService(size_t num_workers, size_t queue_capacity = 1024, size_t ring_capacity = 1024,
+                   const LocatorConfig& config = LocatorConfig())
+        : events(queue_capacity), closed(false), submitting(0), stopping(false), next_ring(0),
+          submitted(0), rejected(0), completed(0), delivered(0), publish_stalls(0), dropped(0) {
+        LocatorConfig worker_config = config;
+        worker_config.use_arena = true;
+        worker_config.pool = nullptr;
+        for (size_t i = 0; i < max(num_workers, size_t(1)); i++) {
+            workers.emplace_back(new Worker(worker_config, ring_capacity));
+        }
+        for (auto& worker : workers) {
+            Worker* w = worker.get();
+            w->runner = thread([this, w] { run(*w); });
+        }
+    }
+    
+    ~LocatorService() { stop(); }
+    
+    LocatorService(const LocatorService&) = delete;
+    LocatorService& operator=(const LocatorService&) = delete;
+    
+    // Thread-safe. Returns false (and counts a rejection) if the queue is
+    // full or the service is stopping; stations are then left with the caller.
+    bool submit(uint64_t event_id, vector<SeismicStation>& stations, const GeoBounds& bounds) {
+        // Announced before the check, so stop() either sees this call or
+        // this call sees closed; both sides are sequentially consistent
+        submitting.fetch_add(1);
+        if (closed.load()) {
+            submitting.fetch_sub(1);
+            rejected.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        Event event{event_id, std::move(stations), bounds, steady_clock::now()};
+        bool pushed = events.tryPush(event);
+        submitting.fetch_sub(1, memory_order_release);
+        if (!pushed) {
+            stations = std::move(event.stations);
+            rejected.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        submitted.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+    
+    // Appends up to max_results finished outcomes to out and returns how many.
+    // Results of one worker arrive in completion order. Call from one
+    // consumer thread only.
+    size_t pollResults(vector<Outcome>& out, size_t max_results = numeric_limits<size_t>::max()) {
+        size_t taken = 0;
+        Published item;
+        for (size_t i = 0; i < workers.size() && taken < max_results; i++) {
+            SpscRing<Published>& ring = workers[(next_ring + i) % workers.size()]->results;
+            while (taken < max_results && ring.tryPop(item)) {
+                delivery_latency.record(steady_clock::now() - item.published);
+                out.push_back(item.outcome);
+                taken++;
+            }
+        }
+        next_ring = (next_ring + 1) % workers.size();
+        delivered.fetch_add(taken, memory_order_relaxed);
+        return taken;
+    }
+    
+    // Stops accepting events, lets the workers finish what is queued and joins
+    // them. Results still in the rings stay available to pollResults.
+    void stop() {
+        // Submissions already past the closed check finish their push
+        // before the workers may exit, so no accepted event is left queued
+        closed.store(true);
+        size_t attempts = 0;
+        while (submitting.load(memory_order_acquire) > 0) {
+            backoff(attempts++);
+        }
+        stopping.store(true, memory_order_release);
+        for (auto& worker : workers) {
+            if (worker->runner.joinable()) {
+                worker->runner.join();
+            }
+        }
+    }
+    
+    size_t workerCount() const { return workers.size(); }
+    
+    Stats stats() const {
+        Stats s;
+        s.submitted = submitted.load(memory_order_relaxed);
+        s.rejected = rejected.load(memory_order_relaxed);
+        s.completed = completed.load(memory_order_relaxed);
+        s.delivered = delivered.load(memory_order_relaxed);
+        s.publish_stalls = publish_stalls.load(memory_order_relaxed);
+        s.dropped = dropped.load(memory_order_relaxed);
+        s.queue_depth = events.sizeApprox();
+        s.queue = queue_latency.snapshot();
+        s.locate = locate_latency.snapshot();
+        s.publish = publish_latency.snapshot();
+        s.delivery = delivery_latency.snapshot();
+        return s;
+    }
+    
+private:
+    void run(Worker& worker) {
+        Event event;
+        size_t idle_polls = 0;
+        while (true) {
+            if (events.tryPop(event)) {
+                process(worker, event);
+                idle_polls = 0;
+                continue;
+            }
+            if (stopping.load(memory_order_acquire)) {
+                // A push may have landed between the pop and the flag check
+                if (events.tryPop(event)) {
+                    process(worker, event);
+                    continue;
+                }
+                return;
+            }
+            backoff(idle_polls++);
+        }
+    }
+    
+    void process(Worker& worker, Event& event) {
+        auto picked = steady_clock::now();
+        queue_latency.record(picked - event.submitted);
+        
+        Published item;
+        item.outcome.event_id = event.event_id;
+        item.outcome.result = worker.locator.locateEpicenter(event.stations, event.bounds);
+        auto located = steady_clock::now();
+        locate_latency.record(located - picked);
+        vector<SeismicStation>().swap(event.stations);
+        
+        // Backpressure from the consumer: wait for ring space, but give up
+        // once stop() has been called so it cannot hang on an idle consumer
+        size_t attempts = 0;
+        while (true) {
+            item.published = steady_clock::now();
+            item.outcome.queue_us = duration<double, micro>(picked - event.submitted).count();
+            item.outcome.locate_us = duration<double, micro>(located - picked).count();
+            item.outcome.publish_us = duration<double, micro>(item.published - located).count();
+            if (worker.results.tryPush(item)) {
+                break;
+            }
+            publish_stalls.fetch_add(1, memory_order_relaxed);
+            if (stopping.load(memory_order_acquire)) {
+                dropped.fetch_add(1, memory_order_relaxed);
+                return;
+            }
+            backoff(attempts++);
+        }
+        publish_latency.record(item.published - located);
+        completed.fetch_add(1, memory_order_relaxed);
+    }
+    
+    // Spin briefly, then yield, then sleep so idle workers leave the CPU
+    static void backoff(size_t attempt) {
+        if (attempt < 64) {
+            return;
+        }
+        if (attempt < 256) {
+            this_thread::yield();
+        } else {
+            this_thread::sleep_for(microseconds(50));
+        }
+    }
+};
+
+#ifndef EARTHQUAKE_LOCATOR_NO_MAIN
+// Locate one event from a binary catalog
+static int locateFromCatalog(const string& path) {
+    StationCatalog catalog;
+    string error;
+    if (!catalog.open(path, &error)) {
+        cerr << error << "\n";
+        return 1;
+    }
+    
+    LocatorConfig config;
+    config.partition_mode = PartitionMode::in_place;
+    EarthquakeEpicenterLocator locator(config);
+    
+    auto start_time = steady_clock::now();
+    EpicenterResult result = locator.locateEpicenter(catalog.view(), catalog.bounds());
+    auto end_time = steady_clock::now();
+    
+    cout << "Stations: " << catalog.size() << "\n";
+    cout << "Calculated epicenter: (" << fixed << setprecision(3) 
+         << result.location.x << ", " << result.location.y << ")\n";
+    cout << "Confidence: " << fixed << setprecision(3) << result.confidence << "\n";
+    cout << "Execution time: " << duration<double, milli>(end_time - start_time).count() << " ms\n";
+    return 0;
+}
+
+#ifdef EARTHQUAKE_INSTRUMENTATION
+// Profile one in-place locate of a synthetic network and write its trace
+static int writeTrace(const string& path, int num_stations) {
+    GeoBounds california(32.0, 42.0, -125.0, -114.0);
+    vector<SeismicStation> stations = 
+        EarthquakeEpicenterLocator::generateEarthquakeData(num_stations, Point(35.0, -120.0), california);
+    
+    LocatorConfig config;
+    config.partition_mode = PartitionMode::in_place;
+    EarthquakeEpicenterLocator locator(config);
+    locator.locateEpicenter(stations, california);
+    
+    const LocatorProfile& profile = locator.getProfile();
+    ofstream out(path);
+    profile.writeChromeTrace(out);
+    if (!out) {
+        cerr << "cannot write " << path << "\n";
+        return 1;
+    }
+    
+    for (int p = 0; p < LocatorProfile::NUM_PHASES; p++) {
+        LocatorProfile::Phase phase = static_cast<LocatorProfile::Phase>(p);
+        cout << setw(10) << LocatorProfile::phaseName(phase) << ": " << fixed << setprecision(1) 
+             << profile.phase_us[p] << " us\n";
+    }
+    cout << "Nodes: " << profile.internal_nodes << " internal, " << profile.leaves << " leaves\n";
+    cout << "Bytes allocated: " << profile.bytes_allocated << "\n";
+    return 0;
+}
+#endif
+
+int main(int argc, char* argv[]) {
+#ifdef EARTHQUAKE_INSTRUMENTATION
+    if ((argc == 3 || argc == 4) && string(argv[1]) == "--trace") {
+        return writeTrace(argv[2], argc == 4 ? atoi(argv[3]) : 100000);
+    }
+#endif
+    if (argc == 4 && string(argv[1]) == "--convert-catalog") {
+        string error;
+        if (!StationCatalog::convertCsv(argv[2], argv[3], &error)) {
+            cerr << error << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (argc == 3 && string(argv[1]) == "--catalog") {
+        return locateFromCatalog(argv[2]);
+    }
+    
     cout << "Earthquake Epicenter Location - Divide & Conquer Algorithm Implementation\n";
     cout << "======================================================================\n\n";
     
@@ -318,9 +7761,9 @@ int main() {
              << station.longitude << ") Time: " << station.detection_time << "s\n";
     }
     
-    auto start_time = high_resolution_clock::now();
+    auto start_time = steady_clock::now();
     EpicenterResult result = locator.locateEpicenter(demo_stations, demo_region);
-    auto end_time = high_resolution_clock::now();
+    auto end_time = steady_clock::now();
     
     auto duration = duration_cast<microseconds>(end_time - start_time);
     
@@ -340,4 +7783,5 @@ int main() {
     cout << "Where n = number of seismic stations\n";
     
     return 0;
-}
\ No newline at end of file
+}
+#endif // EARTHQUAKE_LOCATOR_NO_MAIN
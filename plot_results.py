@@ -1,7 +1,177 @@
+import argparse
+import csv
+import json
+import sys
+
 import pandas as pd
 import matplotlib.pyplot as plt
 import numpy as np
 
+# Benchmark dashboards from earthquake_benchmark JSON output
+# (--benchmark_out=bench.json --benchmark_out_format=json):
+#   python plot_results.py --bench bench.json             summary CSV + scaling curves
+#   python plot_results.py --compare before.json after.json   per-benchmark time ratios
+# Without options the script plots the complexity CSVs as before.
+
+TIME_UNIT_MS = {'ns': 1e-6, 'us': 1e-3, 'ms': 1.0, 's': 1e3}
+SUMMARY_FIELDS = ['commit', 'cpu_model', 'kernels', 'compiler', 'name', 'family',
+                  'partition', 'precision', 'policy', 'threads', 'scaling', 'time_ms',
+                  'p50_us', 'p99_us', 'events_per_s', 'items_per_second', 'allocs_per_iter',
+                  'max_bytes_used']
+
+
+def load_benchmarks(path):
+    """Returns (context, runs): one dict per benchmark with its time in ms,
+    the key=value pairs of its label as fields and the build context."""
+    with open(path) as f:
+        report = json.load(f)
+    context = report.get('context', {})
+    entries = report.get('benchmarks', [])
+    # With --benchmark_repetitions keep the median aggregate of each benchmark
+    if any(entry.get('aggregate_name') == 'median' for entry in entries):
+        entries = [entry for entry in entries if entry.get('aggregate_name') == 'median']
+    else:
+        entries = [entry for entry in entries if entry.get('run_type', 'iteration') == 'iteration']
+
+    runs = []
+    for entry in entries:
+        if entry.get('error_occurred'):
+            continue
+        run = dict(entry)
+        run['name'] = entry.get('run_name', entry['name'])
+        run['family'] = run['name'].split('/')[0]
+        run['time_ms'] = entry['real_time'] * TIME_UNIT_MS[entry.get('time_unit', 'ns')]
+        for pair in entry.get('label', '').split(','):
+            key, sep, value = pair.partition('=')
+            if sep:
+                run[key] = value
+        run['commit'] = context.get('git_commit', 'unknown')
+        for key in ('cpu_model', 'kernels', 'compiler'):
+            run[key] = context.get(key, '')
+        runs.append(run)
+    return context, runs
+
+
+def build_name(context):
+    return f"{context.get('git_commit', 'unknown')} ({context.get('kernels', '?')}, C++{context.get('cplusplus', '????')[2:4]})"
+
+
+def write_summary(runs, path):
+    with open(path, 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=SUMMARY_FIELDS, extrasaction='ignore')
+        writer.writeheader()
+        for run in runs:
+            writer.writerow({field: run.get(field, '') for field in SUMMARY_FIELDS})
+
+
+def plot_scaling(context, runs, scaling, path):
+    """Strong scaling: speedup t(1)/t(p) over a fixed network. Weak scaling:
+    efficiency t(1)/t(p) with the network growing with the threads."""
+    points = sorted((int(run['threads']), run['time_ms']) for run in runs
+                    if run['family'] == 'BM_LocateScaling' and run.get('scaling') == scaling)
+    if not points:
+        return False
+    threads = [p for p, _ in points]
+    base = points[0][1] * threads[0] if scaling == 'strong' else points[0][1]
+    values = [base / t for _, t in points]
+
+    fig, ax = plt.subplots(figsize=(6, 4))
+    ax.plot(threads, values, 'go-', linewidth=2, markersize=6, label='measured')
+    if scaling == 'strong':
+        ax.plot(threads, threads, 'r--', alpha=0.7, label='linear')
+        ax.set_ylabel('Speedup', fontsize=10)
+        title = 'Strong Scaling'
+    else:
+        ax.axhline(1.0, color='r', linestyle='--', alpha=0.7, label='ideal')
+        ax.set_ylabel('Efficiency', fontsize=10)
+        ax.set_ylim([0, 1.2])
+        title = 'Weak Scaling'
+    ax.set_xscale('log', base=2)
+    ax.set_xticks(threads)
+    ax.set_xticklabels([str(p) for p in threads])
+    ax.set_xlabel('Threads', fontsize=10)
+    ax.set_title(f'Earthquake Locator: {title}\n{build_name(context)}', fontsize=11, fontweight='bold')
+    ax.grid(True, alpha=0.3)
+    ax.legend(fontsize=9)
+    plt.tight_layout()
+    plt.savefig(path, dpi=300, bbox_inches='tight')
+    plt.close()
+    return True
+
+
+def bench_dashboard(path):
+    context, runs = load_benchmarks(path)
+    write_summary(runs, 'bench_summary.csv')
+    print(f"Build {build_name(context)} on {context.get('cpu_model', 'unknown CPU')}, "
+          f"{context.get('num_cpus', '?')} CPUs: {len(runs)} runs")
+    print("- bench_summary.csv")
+    for scaling in ('strong', 'weak'):
+        if plot_scaling(context, runs, scaling, f'scaling_{scaling}.png'):
+            print(f"- scaling_{scaling}.png")
+
+
+def compare_dashboard(before_path, after_path, threshold):
+    """Ratio of after to before time for every benchmark run in both files;
+    ratios beyond 1 +- threshold are flagged as regressions or improvements."""
+    before_context, before_runs = load_benchmarks(before_path)
+    after_context, after_runs = load_benchmarks(after_path)
+    before_ms = {run['name']: run['time_ms'] for run in before_runs}
+    rows = [(run['name'], before_ms[run['name']], run['time_ms']) for run in after_runs
+            if run['name'] in before_ms and before_ms[run['name']] > 0]
+    if not rows:
+        print("No benchmark runs in common")
+        return 1
+    rows.sort(key=lambda row: row[2] / row[1])
+
+    with open('bench_compare.csv', 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(['name', 'before_ms', 'after_ms', 'ratio'])
+        for name, before, after in rows:
+            writer.writerow([name, before, after, after / before])
+
+    ratios = [after / before for _, before, after in rows]
+    colors = ['tab:green' if r < 1 - threshold else 'tab:red' if r > 1 + threshold else 'tab:gray'
+              for r in ratios]
+    fig, ax = plt.subplots(figsize=(8, max(3, 0.22 * len(rows))))
+    ax.barh(range(len(rows)), ratios, color=colors)
+    ax.axvline(1.0, color='k', linewidth=1)
+    ax.set_yticks(range(len(rows)))
+    ax.set_yticklabels([name.replace('/min_warmup_time:0.100', '').replace('/manual_time', '')
+                        for name, _, _ in rows], fontsize=6)
+    ax.set_xlabel('Time ratio (after / before, < 1 is faster)', fontsize=10)
+    ax.set_title(f'{build_name(before_context)} -> {build_name(after_context)}', fontsize=11,
+                 fontweight='bold')
+    ax.grid(True, axis='x', alpha=0.3)
+    plt.tight_layout()
+    plt.savefig('bench_compare.png', dpi=300, bbox_inches='tight')
+    plt.close()
+
+    regressions = [(name, r) for (name, _, _), r in zip(rows, ratios) if r > 1 + threshold]
+    improvements = [(name, r) for (name, _, _), r in zip(rows, ratios) if r < 1 - threshold]
+    print(f"{len(rows)} runs compared: {len(improvements)} faster, {len(regressions)} slower "
+          f"(threshold {threshold:.0%})")
+    for name, r in regressions:
+        print(f"  slower {r:.3f}x  {name}")
+    print("- bench_compare.csv")
+    print("- bench_compare.png")
+    return 2 if regressions else 0
+
+
+parser = argparse.ArgumentParser(description='Plot locator complexity and benchmark results')
+parser.add_argument('--bench', metavar='JSON', help='summary and scaling curves of one benchmark run')
+parser.add_argument('--compare', nargs=2, metavar=('BEFORE', 'AFTER'),
+                    help='compare two benchmark runs; exits with 2 on a regression')
+parser.add_argument('--threshold', type=float, default=0.05,
+                    help='relative time change treated as noise by --compare (default 0.05)')
+args = parser.parse_args()
+if args.bench or args.compare:
+    status = 0
+    if args.bench:
+        bench_dashboard(args.bench)
+    if args.compare:
+        status = compare_dashboard(args.compare[0], args.compare[1], args.threshold)
+    sys.exit(status)
+
 # Read the data
 hospital_data = pd.read_csv('complexity_results.csv')
 earthquake_data = pd.read_csv('earthquake_results.csv')